@@ -0,0 +1,160 @@
+/*
+
+Admission Control.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "admission_control.h"          // self
+
+#include <chrono>                       // std::chrono
+#include <cstring>                      // memset
+
+#include "utils/mutex_helper.h"      // MUTEX_SCOPE_LOCK
+
+namespace shopndrop {
+
+const uint32_t AdmissionControl::NUM_PRIORITIES;
+
+AdmissionControl::Guard::Guard( AdmissionControl * ac, priority_e priority ):
+    ac_( ac ),
+    is_admitted_( ac->enter( priority ) )
+{
+}
+
+AdmissionControl::Guard::~Guard()
+{
+    if( is_admitted_ )
+        ac_->leave();
+}
+
+bool AdmissionControl::Guard::is_admitted() const
+{
+    return is_admitted_;
+}
+
+AdmissionControl::AdmissionControl():
+    is_busy_( false )
+{
+    memset( & config_, 0, sizeof( config_ ) );
+    memset( num_waiting_, 0, sizeof( num_waiting_ ) );
+    memset( & stats_, 0, sizeof( stats_ ) );
+}
+
+void AdmissionControl::init( const Config & config )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    config_ = config;
+}
+
+bool AdmissionControl::can_enter__unlocked( priority_e priority ) const
+{
+    if( is_busy_ )
+        return false;
+
+    // low priority requests don't overtake waiting high priority ones
+    return priority == priority_e::HIGH || num_waiting_[ static_cast<uint32_t>( priority_e::HIGH ) ] == 0;
+}
+
+bool AdmissionControl::enter( priority_e priority )
+{
+    auto p = static_cast<uint32_t>( priority );
+
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    if( can_enter__unlocked( priority ) )
+    {
+        is_busy_    = true;
+
+        update_stats__unlocked( priority, true, 0 );
+
+        return true;
+    }
+
+    if( num_waiting_[p] >= config_.max_queue_size[p] )
+    {
+        update_stats__unlocked( priority, false, 0 );
+
+        return false;
+    }
+
+    auto start      = std::chrono::steady_clock::now();
+    auto deadline   = start + std::chrono::milliseconds( config_.max_wait_ms[p] );
+
+    ++num_waiting_[p];
+
+    auto queue_size = num_waiting_[0] + num_waiting_[1];
+
+    if( queue_size > stats_.max_queue_size )
+        stats_.max_queue_size = queue_size;
+
+    auto is_admitted = cond_.wait_until( lock, deadline, [this, priority]{ return can_enter__unlocked( priority ); } );
+
+    --num_waiting_[p];
+
+    if( is_admitted )
+        is_busy_    = true;
+    else
+        cond_.notify_all(); // the queue of high priority could have become empty, let low priority ones re-check
+
+    auto wait_us = static_cast<uint32_t>( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count() );
+
+    update_stats__unlocked( priority, is_admitted, wait_us );
+
+    return is_admitted;
+}
+
+void AdmissionControl::leave()
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    is_busy_    = false;
+
+    cond_.notify_all();
+}
+
+void AdmissionControl::update_stats__unlocked( priority_e priority, bool is_admitted, uint32_t wait_us )
+{
+    auto p = static_cast<uint32_t>( priority );
+
+    if( is_admitted == false )
+    {
+        ++stats_.shed[p];
+        return;
+    }
+
+    ++stats_.admitted[p];
+
+    stats_.total_wait_us    += wait_us;
+
+    if( wait_us > stats_.max_wait_us )
+        stats_.max_wait_us  = wait_us;
+}
+
+AdmissionControl::Stats AdmissionControl::get_and_reset_stats()
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto res = stats_;
+
+    memset( & stats_, 0, sizeof( stats_ ) );
+
+    return res;
+}
+
+} // namespace shopndrop
@@ -0,0 +1,111 @@
+/*
+
+Admission Control.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHOPNDROP__ADMISSION_CONTROL_H
+#define SHOPNDROP__ADMISSION_CONTROL_H
+
+#include <mutex>                    // std::mutex
+#include <condition_variable>       // std::condition_variable
+#include <cstdint>                  // uint32_t
+
+namespace shopndrop {
+
+/**
+ * @brief Gate in front of request processing, admits one request at a time.
+ *
+ * Waiting requests of high priority are admitted before those of low priority.
+ * A request is shed, if the queue of its priority is full or if it has waited longer than
+ * the deadline of its priority.
+ */
+class AdmissionControl
+{
+public:
+
+    enum class priority_e
+    {
+        HIGH    = 0,
+        LOW     = 1,
+    };
+
+    static const uint32_t NUM_PRIORITIES   = 2;
+
+    struct Config
+    {
+        uint32_t    max_queue_size[NUM_PRIORITIES];
+        uint32_t    max_wait_ms[NUM_PRIORITIES];
+    };
+
+    struct Stats
+    {
+        uint32_t    admitted[NUM_PRIORITIES];
+        uint32_t    shed[NUM_PRIORITIES];
+        uint32_t    max_queue_size;
+        uint64_t    total_wait_us;
+        uint32_t    max_wait_us;
+    };
+
+    class Guard
+    {
+    public:
+        Guard( AdmissionControl * ac, priority_e priority );
+        ~Guard();
+
+        bool is_admitted() const;
+
+    private:
+        AdmissionControl    * ac_;
+        bool                is_admitted_;
+    };
+
+public:
+
+    AdmissionControl();
+
+    void init( const Config & config );
+
+    // returns false, if the request was shed
+    bool enter( priority_e priority );
+    void leave();
+
+    // returns the stats since the previous call and resets them
+    Stats get_and_reset_stats();
+
+private:
+
+    bool can_enter__unlocked( priority_e priority ) const;
+
+    void update_stats__unlocked( priority_e priority, bool is_admitted, uint32_t wait_us );
+
+private:
+    std::mutex                  mutex_;
+    std::condition_variable     cond_;
+
+    Config                      config_;
+
+    bool                        is_busy_;
+    uint32_t                    num_waiting_[NUM_PRIORITIES];
+
+    Stats                       stats_;
+};
+
+} // namespace shopndrop
+
+#endif // SHOPNDROP__ADMISSION_CONTROL_H
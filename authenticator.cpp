@@ -23,8 +23,11 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "authenticator.h"              // self
 
+#include <chrono>                       // std::chrono
+
 #include "utils/dummy_logger.h"      // dummy_log
 #include "utils/utils_assert.h"      // ASSERT
+#include "utils/mutex_helper.h"      // MUTEX_SCOPE_LOCK
 
 #include "password_hasher/login_to_id_converter.h"      // password_hasher::convert_password_to_hash
 
@@ -32,8 +35,17 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 namespace shopndrop {
 
+const uint32_t Authenticator::MAX_FAILED_ATTEMPTS;
+const uint32_t Authenticator::FAILED_ATTEMPTS_WINDOW_SEC;
+
 Authenticator::Authenticator():
-    user_man_( nullptr )
+    user_man_( nullptr ),
+    attempts_( 0 ),
+    succeeded_( 0 ),
+    failed_( 0 ),
+    throttled_( 0 ),
+    total_time_us_( 0 ),
+    max_time_us_( 0 )
 {
 }
 
@@ -49,19 +61,134 @@ bool Authenticator::init(
 
 // interface session_manager::IAuthenticator
 bool Authenticator::is_authenticated( uint32_t user_id, const std::string & password ) const
+{
+    ++attempts_;
+
+    if( is_throttled( user_id ) )
+    {
+        dummy_log_info( MODULENAME, "is_authenticated: too many failed attempts for user id %u", user_id );
+
+        ++failed_;
+        ++throttled_;
+
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto res = check_password( user_id, password );
+
+    auto time_us = static_cast<uint32_t>( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count() );
+
+    if( res )
+        ++succeeded_;
+    else
+        ++failed_;
+
+    total_time_us_ += time_us;
+
+    auto max = max_time_us_.load();
+
+    while( time_us > max && max_time_us_.compare_exchange_weak( max, time_us ) == false )
+    {
+    }
+
+    return res;
+}
+
+bool Authenticator::is_throttled( uint32_t user_id ) const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto it = failed_attempts_.find( user_id );
+
+    if( it == failed_attempts_.end() )
+        return false;
+
+    if( Clock::now() >= it->second.window_end )
+    {
+        failed_attempts_.erase( it );
+        return false;
+    }
+
+    return it->second.num >= MAX_FAILED_ATTEMPTS;
+}
+
+void Authenticator::update_failed_attempts( uint32_t user_id, bool is_succeeded ) const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    if( is_succeeded )
+    {
+        failed_attempts_.erase( user_id );
+        return;
+    }
+
+    auto now = Clock::now();
+
+    auto & e = failed_attempts_[ user_id ];
+
+    // a new entry has an empty window, which is expired
+    if( now >= e.window_end )
+    {
+        e.num           = 0;
+        e.window_end    = now + std::chrono::seconds( FAILED_ATTEMPTS_WINDOW_SEC );
+    }
+
+    ++e.num;
+}
+
+bool Authenticator::is_equal( const std::string & a, const std::string & b )
+{
+    // time doesn't depend on the position of the first mismatch
+    if( a.size() != b.size() )
+        return false;
+
+    unsigned char diff = 0;
+
+    for( size_t i = 0; i < a.size(); ++i )
+        diff |= static_cast<unsigned char>( a[i] ^ b[i] );
+
+    return diff == 0;
+}
+
+Authenticator::Stats Authenticator::get_and_reset_stats()
+{
+    Stats res;
+
+    res.attempts        = attempts_.exchange( 0 );
+    res.succeeded       = succeeded_.exchange( 0 );
+    res.failed          = failed_.exchange( 0 );
+    res.throttled       = throttled_.exchange( 0 );
+    res.total_time_us   = total_time_us_.exchange( 0 );
+    res.max_time_us     = max_time_us_.exchange( 0 );
+
+    return res;
+}
+
+bool Authenticator::check_password( uint32_t user_id, const std::string & password ) const
 {
     auto u = user_man_->find__unlocked( user_id );
 
+    auto password_hash = password_hasher::convert_password_to_hash( password );
+
     if( u.is_empty() )
     {
+        static const std::string dummy_hash = password_hasher::convert_password_to_hash( "" );
+
+        // same work as for a known user
+        is_equal( dummy_hash, password_hash );
+
         dummy_log_info( MODULENAME, "is_authenticated: unknown user id %u", user_id );
 
         return false;
     }
 
-    auto password_hash = password_hasher::convert_password_to_hash( password );
+    auto res = is_equal( u.get_password_hash(), password_hash );
+
+    update_failed_attempts( user_id, res );
 
-    if( u.get_password_hash() == password_hash )
+    if( res )
     {
         dummy_log_info( MODULENAME, "is_authenticated: authenticated user id %u", user_id );
 
@@ -24,19 +24,39 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #ifndef SHOPNDROP_AUTHENTICATOR_H
 #define SHOPNDROP_AUTHENTICATOR_H
 
-#include <mutex>            // std::mutex
-#include <map>              // std::map
 #include <cstdint>          // uint32_t
+#include <atomic>           // std::atomic
+#include <string>           // std::string
+#include <mutex>            // std::mutex
+#include <unordered_map>    // std::unordered_map
+#include <chrono>           // std::chrono
 
 #include "session_manager/i_authenticator.h" // session_manager::IAuthenticator
 #include "user_manager/user_manager.h"       // user_manager::UserManager
 
 namespace shopndrop {
 
+/**
+ * @brief Checks passwords of OpenSession requests and counts login attempts separately from API traffic.
+ *
+ * After MAX_FAILED_ATTEMPTS failed logins within FAILED_ATTEMPTS_WINDOW_SEC further logins of the user
+ * are rejected without hashing until the window ends. Unknown users are hashed against a dummy hash,
+ * so that the response time doesn't tell whether a user exists.
+ */
 class Authenticator: public session_manager::IAuthenticator
 {
 public:
 
+    struct Stats
+    {
+        uint32_t    attempts;
+        uint32_t    succeeded;
+        uint32_t    failed;
+        uint32_t    throttled;      // part of failed, rejected without hashing
+        uint64_t    total_time_us;  // time spent in hashing and comparison
+        uint32_t    max_time_us;
+    };
+
     Authenticator();
 
     bool init(
@@ -45,10 +65,46 @@ public:
     // interface session_manager::IAuthenticator
     virtual bool is_authenticated( uint32_t user_id, const std::string & password ) const;
 
+    // returns the stats since the previous call and resets them
+    Stats get_and_reset_stats();
+
+private:
+
+    typedef std::chrono::steady_clock   Clock;
+
+    struct FailedAttempts
+    {
+        uint32_t            num;
+        Clock::time_point   window_end;
+    };
+
+    typedef std::unordered_map<uint32_t, FailedAttempts>    MapUserIdToFailedAttempts;
+
+    static const uint32_t   MAX_FAILED_ATTEMPTS         = 5;
+    static const uint32_t   FAILED_ATTEMPTS_WINDOW_SEC  = 300;
+
 private:
 
+    bool check_password( uint32_t user_id, const std::string & password ) const;
+
+    bool is_throttled( uint32_t user_id ) const;
+    void update_failed_attempts( uint32_t user_id, bool is_succeeded ) const;
+
+    static bool is_equal( const std::string & a, const std::string & b );
+
+private:
     // Config
     user_manager::UserManager   * user_man_;
+
+    mutable std::atomic<uint32_t>   attempts_;
+    mutable std::atomic<uint32_t>   succeeded_;
+    mutable std::atomic<uint32_t>   failed_;
+    mutable std::atomic<uint32_t>   throttled_;
+    mutable std::atomic<uint64_t>   total_time_us_;
+    mutable std::atomic<uint32_t>   max_time_us_;
+
+    mutable std::mutex                  mutex_;             // protects failed_attempts_
+    mutable MapUserIdToFailedAttempts   failed_attempts_;   // known users only, so its size is bounded by the user DB
 };
 
 } // namespace shopndrop
@@ -44,10 +44,24 @@ void init_config( Core::Config * cfg, const config_reader::ConfigReader & cr )
     GET_VALUE( request_log     , section, true );
     GET_VALUE_CONVERTED( request_log_rotation_interval_min, section, true );
     GET_VALUE( users_db_file, section, true );
+    GET_VALUE_CONVERTED( users_db_save_interval_min, section, true );
     GET_VALUE( user_reg_email_credentials_file,         section, true );
     GET_VALUE( timezone_file   , section, true );
 
     GET_VALUE( goodies_db_file,             section, true );
+    GET_VALUE( id_gen_file,                 section, true );
+    GET_VALUE_CONVERTED( id_gen_block_size, section, true );
+
+    // optional, the defaults suit max_threads=5: at most 4 requests can wait for the gate
+    cfg->admission_max_queue_size_high  = 4;
+    cfg->admission_max_queue_size_low   = 2;
+    cfg->admission_max_wait_ms_high     = 2000;
+    cfg->admission_max_wait_ms_low      = 300;
+
+    GET_VALUE_CONVERTED( admission_max_queue_size_high, section, false );
+    GET_VALUE_CONVERTED( admission_max_queue_size_low,  section, false );
+    GET_VALUE_CONVERTED( admission_max_wait_ms_high,    section, false );
+    GET_VALUE_CONVERTED( admission_max_wait_ms_low,     section, false );
 }
 
 void init_scheduler( uint32_t * granularity_ms, const config_reader::ConfigReader & cr )
@@ -42,7 +42,7 @@ Core::~Core()
     }
 }
 
-void Core::init(
+bool Core::init(
         const Config                            & config,
         const session_manager::Config           & sesman_config,
         const user_reg::Config                  & user_reg_config,
@@ -51,7 +51,8 @@ void Core::init(
         uint32_t                                log_id_handler,
         uint32_t                                log_id_ride,
         uint32_t                                log_id_order,
-        scheduler::IScheduler                   * sched )
+        scheduler::IScheduler                   * sched,
+        std::string                             * error_msg )
 {
     MUTEX_SCOPE_LOCK( mutex_ );
 
@@ -61,12 +62,21 @@ void Core::init(
 
     user_reg_handler_thunk_.init( log_id_handler, & gh_, & user_reg_handler_ );
 
-    sh_.init( & perm_checker_, & ht_, & user_reg_handler_thunk_, config.request_log, config.request_log_rotation_interval_min );
+    // limits of the admission gate per priority, from the admission_* keys of the [core] section
+    AdmissionControl::Config admission_config =
+    {
+        { config.admission_max_queue_size_high, config.admission_max_queue_size_low },
+        { config.admission_max_wait_ms_high, config.admission_max_wait_ms_low },
+    };
+
+    sh_.init( & perm_checker_, & ht_, & user_reg_handler_thunk_, & goodies_db_, config.request_log, config.request_log_rotation_interval_min, admission_config );
 
     gh_.init( & sess_man_, & user_man_ );
 
     user_man_.init( config.users_db_file );
 
+    user_db_saver_.init( & user_man_, config.users_db_file, config.users_db_save_interval_min );
+
     authen_.init( & user_man_ );
 
     generic_perm_checker_.init( & sess_man_ );
@@ -79,7 +89,12 @@ void Core::init(
 
     sess_man_.init( & authen_, sesman_config );
 
-    goodies_db_.init( config_.goodies_db_file );
+    // without the catalog no order can be placed, so don't start
+    if( goodies_db_.init( config_.goodies_db_file ) == false )
+    {
+        * error_msg = "cannot load product catalog " + config_.goodies_db_file;
+        return false;
+    }
 
     ht_.init( log_id_handler,
             & gh_, & h_ );
@@ -98,24 +113,35 @@ void Core::init(
 
     db::OrderDB::Config job_db_config;
 
-    job_db_config.status_file  = config.db_status_file;
+    job_db_config.status_file       = config.db_status_file;
+    job_db_config.id_gen_file       = config.id_gen_file;
+    job_db_config.id_gen_block_size = config.id_gen_block_size;
 
-    db_.init( job_db_config, log_id_db, log_id_ride, log_id_order, & user_man_ /*, & db_obj_gen_ */);
+    // without a reserved id block ids could repeat after a restart, so don't start
+    if( db_.init( job_db_config, log_id_db, log_id_ride, log_id_order, & user_man_ /*, & db_obj_gen_ */) == false )
+    {
+        * error_msg = "cannot initialize order db, id generator file " + config.id_gen_file;
+        return false;
+    }
 
     periodic_call_gen_.init( sched );
 
     periodic_call_gen_.register_callee( this );
+
+    user_db_saver_.start();
+
+    return true;
 }
 
 void Core::shutdown()
 {
     dummy_log_info( MODULENAME, "shutdown" );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    user_db_saver_.shutdown();
 
-    std::string error_msg;
+    MUTEX_SCOPE_LOCK( mutex_ );
 
-    user_man_.save( & error_msg, config_.users_db_file );
+    user_db_saver_.save();
 }
 
 restful_interface::IHandler* Core::get_http_handler()
@@ -129,17 +155,43 @@ restful_interface::IHandler* Core::get_http_handler()
 void Core::once_per_minute()
 {
     //once_per_hour();    // for tests
+
+    goodies_db_.reload_if_changed();
+
+    perm_checker_.purge_session_cache();
+
+    db_.expire_rides();
+
+    auto ac_stats = sh_.get_and_reset_admission_stats();
+
+    auto num_admitted = ac_stats.admitted[0] + ac_stats.admitted[1];
+
+    if( num_admitted > 0 || ac_stats.shed[0] > 0 || ac_stats.shed[1] > 0 )
+    {
+        dummy_log_info( MODULENAME, "admission stats: admitted %u/%u, shed %u/%u (high/low), max queue size %u, avg wait %u us, max wait %u us",
+                ac_stats.admitted[0], ac_stats.admitted[1], ac_stats.shed[0], ac_stats.shed[1], ac_stats.max_queue_size,
+                num_admitted ? static_cast<uint32_t>( ac_stats.total_wait_us / num_admitted ) : 0, ac_stats.max_wait_us );
+    }
+}
+
+bool Core::reload_goodies_db()
+{
+    dummy_log_info( MODULENAME, "reload_goodies_db" );
+
+    return goodies_db_.reload();
 }
 
 void Core::once_per_hour()
 {
     dummy_log_trace( MODULENAME, "once_per_hour" );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    auto login_stats = authen_.get_and_reset_stats();
 
-    std::string error_msg;
+    dummy_log_info( MODULENAME, "login stats: attempts %u, succeeded %u, failed %u, throttled %u, avg time %u us, max time %u us",
+            login_stats.attempts, login_stats.succeeded, login_stats.failed, login_stats.throttled,
+            login_stats.attempts ? static_cast<uint32_t>( login_stats.total_time_us / login_stats.attempts ) : 0, login_stats.max_time_us );
 
-    user_man_.save( & error_msg, config_.users_db_file );
+    // user DB is saved by user_db_saver_ in its own thread
 }
 
 } // namespace shopndrop
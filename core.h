@@ -45,6 +45,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "user_reg_handler/handler.h"       // user_reg_handler::Handler
 #include "user_reg_handler/handler_thunk.h" // user_reg_handler::HandlerThunk
 #include "goodies_db.h"                     // GoodiesDB
+#include "user_db_saver.h"                  // UserDbSaver
 
 namespace scheduler
 {
@@ -62,9 +63,16 @@ public:
         std::string request_log;
         uint32_t    request_log_rotation_interval_min;
         std::string users_db_file;
+        uint32_t    users_db_save_interval_min;
         std::string user_reg_email_credentials_file;
         std::string timezone_file;
         std::string goodies_db_file;
+        std::string id_gen_file;
+        uint32_t    id_gen_block_size;
+        uint32_t    admission_max_queue_size_high;
+        uint32_t    admission_max_queue_size_low;
+        uint32_t    admission_max_wait_ms_high;
+        uint32_t    admission_max_wait_ms_low;
     };
 
 public:
@@ -72,7 +80,7 @@ public:
     Core();
     ~Core();
 
-    void init(
+    bool init(
             const Config                            & config,
             const session_manager::Config           & sesman_config,
             const user_reg::Config                  & user_reg_config,
@@ -81,7 +89,8 @@ public:
             uint32_t                                log_id_handler,
             uint32_t                                log_id_ride,
             uint32_t                                log_id_order,
-            scheduler::IScheduler                   * sched );
+            scheduler::IScheduler                   * sched,
+            std::string                             * error_msg );
 
     void shutdown();
 
@@ -91,6 +100,8 @@ public:
     void once_per_minute() override;
     void once_per_hour() override;
 
+    bool reload_goodies_db();
+
 private:
 
 
@@ -116,6 +127,7 @@ private:
     user_reg_handler::HandlerThunk  user_reg_handler_thunk_;
     periodic_call_gen::PeriodicCallGen      periodic_call_gen_;
     GoodiesDB                       goodies_db_;
+    UserDbSaver                     user_db_saver_;
 
     utils::TimeZoneConverter    tzc_;
     TimeAdjuster                time_adj_;
@@ -52,7 +52,13 @@ const shopndrop_protocol::Ride * ObjGenerator::to_Ride(
             const db::Ride                  & ride,
             const std::string               & timezone )
 {
-    * res  = ride.get_ride();
+    auto & raw_ride = ride.get_ride();
+
+    // copy member-wise, raw_ride.pending_order_ids is not used by db::Ride
+    res->is_open            = raw_ride.is_open;
+    res->summary            = raw_ride.summary;
+    res->accepted_order_id  = raw_ride.accepted_order_id;
+    res->resolution         = raw_ride.resolution;
 
     time_adj_->to_local( & res->summary.delivery_time, ride.get_delivery_time(), timezone );
 
@@ -63,29 +69,30 @@ const shopndrop_protocol::Ride * ObjGenerator::to_Ride(
 
 const shopndrop_web_protocol::DashScreenUser * ObjGenerator::to_DashScreenUser(
         shopndrop_web_protocol::DashScreenUser * res,
-        const std::vector<db::Ride*>    & rides,
-        const std::vector<db::Order*>   & orders,
+        const std::vector<std::shared_ptr<const db::Ride>>   & rides,
+        const std::vector<std::shared_ptr<const db::Order>>  & orders,
         uint32_t                        current_time,
         const std::string               & timezone )
 {
     time_adj_->to_local( & res->current_time, current_time, timezone );
 
+    // construct elements in place to avoid copying of temporaries
+    res->rides.reserve( res->rides.size() + rides.size() );
+
     for( auto & r : rides )
     {
-        shopndrop_web_protocol::RideSummaryWithShopper t;
-
-        to_RideSummaryWithShopper( & t, * r, timezone );
+        res->rides.emplace_back();
 
-        res->rides.push_back( t );
+        to_RideSummaryWithShopper( & res->rides.back(), * r, timezone );
     }
 
+    res->orders.reserve( res->orders.size() + orders.size() );
+
     for( auto & r : orders )
     {
-        shopndrop_web_protocol::AcceptedOrderUser t;
-
-        to_AcceptedOrderUser( & t, * r, timezone );
+        res->orders.emplace_back();
 
-        res->orders.push_back( t );
+        to_AcceptedOrderUser( & res->orders.back(), * r, timezone );
     }
 
     return res;
@@ -93,29 +100,30 @@ const shopndrop_web_protocol::DashScreenUser * ObjGenerator::to_DashScreenUser(
 
 const shopndrop_web_protocol::DashScreenShopper * ObjGenerator::to_DashScreenShopper(
         shopndrop_web_protocol::DashScreenShopper * res,
-        const std::vector<db::Ride*>    & rides,
-        const std::vector<db::Order*>   & orders,
+        const std::vector<std::shared_ptr<const db::Ride>>   & rides,
+        const std::vector<std::shared_ptr<const db::Order>>  & orders,
         uint32_t                        current_time,
         const std::string               & timezone )
 {
     time_adj_->to_local( & res->current_time, current_time, timezone );
 
+    // construct elements in place to avoid copying of temporaries
+    res->rides.reserve( res->rides.size() + rides.size() );
+
     for( auto & r : rides )
     {
-        shopndrop_web_protocol::RideWithId t;
-
-        to_RideWithId( & t, * r, timezone );
+        res->rides.emplace_back();
 
-        res->rides.push_back( t );
+        to_RideWithId( & res->rides.back(), * r, timezone );
     }
 
+    res->orders.reserve( res->orders.size() + orders.size() );
+
     for( auto & r : orders )
     {
-        shopndrop_web_protocol::AcceptedOrderShopper t;
-
-        to_AcceptedOrderShopper( & t, * r, timezone );
+        res->orders.emplace_back();
 
-        res->orders.push_back( t );
+        to_AcceptedOrderShopper( & res->orders.back(), * r, timezone );
     }
 
     return res;
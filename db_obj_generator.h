@@ -24,6 +24,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #ifndef SHOPNDROP_DB_OBJ_GENERATOR_H
 #define SHOPNDROP_DB_OBJ_GENERATOR_H
 
+#include <memory>                       // std::shared_ptr
+
 #include "shopndrop_web_protocol/protocol.h"  // shopndrop_protocol::Ride
 #include "db_ride.h"                    // db::Ride
 #include "db_order.h"                   // db::Order
@@ -47,15 +49,15 @@ public:
 
     const shopndrop_web_protocol::DashScreenUser * to_DashScreenUser(
             shopndrop_web_protocol::DashScreenUser * res,
-            const std::vector<db::Ride*>    & rides,
-            const std::vector<db::Order*>   & orders,
+            const std::vector<std::shared_ptr<const db::Ride>>   & rides,
+            const std::vector<std::shared_ptr<const db::Order>>  & orders,
             uint32_t                        current_time,
             const std::string               & timezone );
 
     const shopndrop_web_protocol::DashScreenShopper * to_DashScreenShopper(
             shopndrop_web_protocol::DashScreenShopper * res,
-            const std::vector<db::Ride*>    & rides,
-            const std::vector<db::Order*>   & orders,
+            const std::vector<std::shared_ptr<const db::Ride>>   & rides,
+            const std::vector<std::shared_ptr<const db::Order>>  & orders,
             uint32_t                        current_time,
             const std::string               & timezone );
 
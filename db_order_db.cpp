@@ -26,6 +26,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <fstream>                      // std::ofstream
 #include <sstream>                      // std::ostringstream
 #include <algorithm>                    // std::sort
+#include <atomic>                       // std::atomic_thread_fence
 
 #include "utils/mutex_helper.h"      // MUTEX_SCOPE_LOCK
 #include "utils/dummy_logger.h"      // dummy_log
@@ -54,8 +55,7 @@ OrderDB::OrderDB():
     log_id_order_( 0 ),
     user_man_( nullptr ),
     //obj_gen_( nullptr ),
-    is_status_loaded_( false ),
-    last_order_id_( 0 )
+    is_status_loaded_( false )
 {
 }
 
@@ -69,11 +69,6 @@ OrderDB::~OrderDB()
     {
         dummy_log_warn( MODULENAME, "status will not be saved" );
     }
-
-    for( auto e : map_id_to_order_ )
-    {
-        delete e.second;
-    }
 }
 
 bool OrderDB::init(
@@ -92,21 +87,22 @@ bool OrderDB::init(
     log_id_order_       = log_id_order;
     user_man_           = user_man;
 
-    is_status_loaded_   = true;
+    std::string error_msg;
 
-    return true;
-}
+    if( id_gen_.init( config.id_gen_file, config.id_gen_block_size, & error_msg ) == false )
+    {
+        dummy_log_error( MODULENAME, "cannot init id generator: %s", error_msg.c_str() );
+        return false;
+    }
 
-id_t OrderDB::get_next_id()
-{
-    MUTEX_SCOPE_LOCK( mutex_ );
+    is_status_loaded_   = true;
 
-    return get_next_id__intern();
+    return true;
 }
 
-id_t OrderDB::get_next_id__intern()
+bool OrderDB::get_next_id( id_t * id, std::string * error_msg )
 {
-    return ++last_order_id_;
+    return id_gen_.get_next_id( id, error_msg );
 }
 
 bool OrderDB::find_user_id_by_order_id( user_id_t * user_id, id_t order_id ) const
@@ -129,17 +125,19 @@ bool OrderDB::create_and_add_ride( id_t * ride_id, const shopndrop_protocol::Rid
 {
     LOG_TRACE( "create_and_add_ride: user_id %u", user_id );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    id_t id;
 
-    auto id = get_next_id__intern();
+    if( get_next_id( & id, error_msg ) == false )
+        return false;
 
-    auto ride = new Ride( id, user_id, log_id_ride_, ride_summary, delivery_time, shopper_name );
+    auto ride = std::make_shared<Ride>( id, user_id, log_id_ride_, ride_summary, delivery_time, shopper_name );
+
+    MUTEX_SCOPE_LOCK( mutex_ );
 
     auto b = add_ride( id, ride, user_id, error_msg );
 
     if( b == false )
     {
-        delete ride;
         return false;
     }
 
@@ -148,7 +146,7 @@ bool OrderDB::create_and_add_ride( id_t * ride_id, const shopndrop_protocol::Rid
     return true;
 }
 
-bool OrderDB::add_ride( id_t id, Ride * ride, user_id_t user_id, std::string * error_msg )
+bool OrderDB::add_ride( id_t id, const std::shared_ptr<Ride> & ride, user_id_t user_id, std::string * error_msg )
 {
     LOG_TRACE( "add_ride: ride_id %u, user_id %u", id, user_id );
 
@@ -160,13 +158,15 @@ bool OrderDB::add_ride( id_t id, Ride * ride, user_id_t user_id, std::string * e
         return false;
     }
 
+    ride_deadlines_.push( Deadline( ride->get_delivery_time(), id ) );
+
     return true;
 }
 
 bool OrderDB::create_and_add_order(
         id_t                * order_id,
         id_t                ride_id,
-        const shopndrop_protocol::ShoppingList & shopping_list,
+        const shopndrop_web_protocol::ShoppingListWithTotals & shopping_list,
         const shopndrop_protocol::Address & delivery_address,
         double              sum,
         double              weight,
@@ -178,11 +178,24 @@ bool OrderDB::create_and_add_order(
 {
     LOG_TRACE( "create_and_add_order: user_id %u, ride_id %u, shopper_name '%s'", user_id, ride_id, shopper_name );
 
-    MUTEX_SCOPE_LOCK( mutex_ );
+    // ids and records are prepared outside of the lock
+    id_t shopping_list_id;
+    id_t id;
+
+    if( get_next_id( & shopping_list_id, error_msg ) == false || get_next_id( & id, error_msg ) == false )
+        return false;
+
+    auto shopping_list_i    = std::make_shared<ShoppingList>( shopping_list_id, user_id, shopping_list );
 
-    auto shopping_list_id = get_next_id__intern();
+    auto order    = std::make_shared<Order>( id, user_id, log_id_order_, ride_id, shopping_list_id, delivery_address );
 
-    auto shopping_list_i    = new ShoppingList( shopping_list_id, user_id, shopping_list );
+    init_cache( & order->get_cache(), sum, weight, earning, delivery_time, shopper_name );
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    // the ride could have been closed since the request was validated
+    if( can_add_order_to_ride__unlocked( ride_id, user_id, error_msg ) == false )
+        return false;
 
     auto b = add_shopping_list( shopping_list_id, shopping_list_i, user_id, error_msg );
 
@@ -191,17 +204,10 @@ bool OrderDB::create_and_add_order(
         return false;
     }
 
-    auto id = get_next_id__intern();
-
-    auto order    = new Order( id, user_id, log_id_order_, ride_id, shopping_list_id, delivery_address );
-
-    init_cache( & order->get_cache(), sum, weight, earning, delivery_time, shopper_name );
-
     b = add_order( id, order, user_id, error_msg );
 
     if( b == false )
     {
-        delete order;
         return false;
     }
 
@@ -210,6 +216,148 @@ bool OrderDB::create_and_add_order(
     return add_pending_order_to_ride( id, ride_id, user_id, error_msg );
 }
 
+void OrderDB::create_and_add_rides( std::vector<BatchResult> * res, const std::vector<NewRide> & rides, const std::string & shopper_name, user_id_t user_id )
+{
+    LOG_TRACE( "create_and_add_rides: user_id %u, size %u", user_id, static_cast<uint32_t>( rides.size() ) );
+
+    auto first = res->size();
+
+    res->resize( first + rides.size(), BatchResult { 0, std::string() } );
+
+    // rides without id stay nullptr, their error is already in res
+    std::vector<std::shared_ptr<Ride>> new_rides( rides.size() );
+
+    for( uint32_t i = 0; i < rides.size(); ++i )
+    {
+        auto & r = rides[i];
+
+        id_t id;
+
+        if( get_next_id( & id, & ( * res )[first + i].error_msg ) == false )
+            continue;
+
+        new_rides[i] = std::make_shared<Ride>( id, user_id, log_id_ride_, r.ride_summary, r.delivery_time, shopper_name );
+    }
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    for( uint32_t i = 0; i < new_rides.size(); ++i )
+    {
+        auto & ride = new_rides[i];
+
+        if( ride == nullptr )
+            continue;
+
+        auto id = ride->get_attrib().id;
+
+        auto & e = ( * res )[first + i];
+
+        e.id = add_ride( id, ride, user_id, & e.error_msg ) ? id : 0;
+    }
+}
+
+void OrderDB::create_and_add_orders( std::vector<BatchResult> * res, const std::vector<NewOrder> & orders, user_id_t user_id )
+{
+    LOG_TRACE( "create_and_add_orders: user_id %u, size %u", user_id, static_cast<uint32_t>( orders.size() ) );
+
+    typedef std::pair<ShoppingListPtr, std::shared_ptr<Order>> Entry;
+
+    auto first = res->size();
+
+    res->resize( first + orders.size(), BatchResult { 0, std::string() } );
+
+    // entries without ids stay empty, their error is already in res
+    std::vector<Entry> entries( orders.size() );
+
+    for( uint32_t i = 0; i < orders.size(); ++i )
+    {
+        auto & o = orders[i];
+
+        id_t shopping_list_id;
+        id_t id;
+
+        auto error_msg = & ( * res )[first + i].error_msg;
+
+        if( get_next_id( & shopping_list_id, error_msg ) == false || get_next_id( & id, error_msg ) == false )
+            continue;
+
+        auto shopping_list  = std::make_shared<ShoppingList>( shopping_list_id, user_id, o.shopping_list );
+
+        auto order          = std::make_shared<Order>( id, user_id, log_id_order_, o.ride_id, shopping_list_id, o.delivery_address );
+
+        init_cache( & order->get_cache(), o.sum, o.weight, o.earning, o.delivery_time, o.shopper_name );
+
+        entries[i] = Entry( shopping_list, order );
+    }
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    for( uint32_t i = 0; i < entries.size(); ++i )
+    {
+        auto & shopping_list    = entries[i].first;
+        auto & order            = entries[i].second;
+
+        if( order == nullptr )
+            continue;
+
+        auto ride_id            = orders[i].ride_id;
+        auto id                 = order->get_attrib().id;
+
+        auto & e = ( * res )[first + i];
+
+        // check the ride first, so that a failed item doesn't leave anything behind
+        if( can_add_order_to_ride__unlocked( ride_id, user_id, & e.error_msg ) == false )
+            continue;
+
+        auto shopping_list_id   = shopping_list->get_attrib().id;
+
+        if( add_shopping_list( shopping_list_id, shopping_list, user_id, & e.error_msg ) == false )
+            continue;
+
+        if( add_order( id, order, user_id, & e.error_msg ) == false )
+        {
+            map_id_to_shopping_list_.erase( shopping_list_id );
+            continue;
+        }
+
+        // an order which is not attached to its ride could never be accepted, so it is rolled back
+        if( add_pending_order_to_ride( id, ride_id, user_id, & e.error_msg ) == false )
+        {
+            map_id_to_order_.erase( id );
+            map_id_to_shopping_list_.erase( shopping_list_id );
+            continue;
+        }
+
+        e.id = id;
+    }
+}
+
+bool OrderDB::can_add_order_to_ride__unlocked( id_t ride_id, user_id_t user_id, std::string * error_msg ) const
+{
+    auto ride = find_ride__unlocked( ride_id );
+
+    if( ride == nullptr )
+    {
+        * error_msg = "ride " + std::to_string( ride_id ) + " not found";
+        return false;
+    }
+
+    // cancelled, delivered or expired
+    if( ride->get_ride().is_open == false )
+    {
+        * error_msg = "ride " + std::to_string( ride_id ) + " is closed";
+        return false;
+    }
+
+    if( user_id == ride->get_attrib().user_id )
+    {
+        * error_msg = "ride " + std::to_string( ride_id ) + " belongs to the same user " + std::to_string( user_id );
+        return false;
+    }
+
+    return true;
+}
+
 bool OrderDB::cancel_ride( id_t ride_id, user_id_t user_id, std::string * error_msg )
 {
     LOG_TRACE( "cancel_ride: ride_id %u, user_id %u", ride_id, user_id );
@@ -236,7 +384,7 @@ bool OrderDB::cancel_ride( id_t ride_id, user_id_t user_id, std::string * error_
 
     if( ride_raw.accepted_order_id != 0 )
     {
-        auto order = find_order__unlocked( ride_raw.accepted_order_id );
+        auto order = modify_order__unlocked( ride_raw.accepted_order_id );
 
         assert( order );
 
@@ -245,14 +393,14 @@ bool OrderDB::cancel_ride( id_t ride_id, user_id_t user_id, std::string * error_
 
     // no need to cancel pending orders, as they have to be already declined, SKV 19520
 
-    ride->cancel_ride();
+    modify_ride__unlocked( ride_id )->cancel_ride();
 
     return true;
 }
 
 void OrderDB::accept_order_by_id( id_t order_id, bool should_accept )
 {
-    auto order = find_order__unlocked( order_id );
+    auto order = modify_order__unlocked( order_id );
 
     assert( order );
 
@@ -265,49 +413,61 @@ bool OrderDB::accept_order( id_t order_id, user_id_t user_id, bool should_accept
 
     MUTEX_SCOPE_LOCK( mutex_ );
 
-    VectorRide rides;
+    id_t ride_id = 0;
 
-    find_open_rides_with_unaccepted_orders_for_user( & rides, user_id );
+    {
+        VectorRide rides;
+
+        find_open_rides_with_unaccepted_orders_for_user( & rides, user_id );
+
+        if( rides.empty() )
+        {
+            * error_msg = "no offered rides found for user " + std::to_string( user_id );
+
+            return false;
+        }
 
-    if( rides.empty() )
+        for( auto & r : rides )
+        {
+            if( r->has_pending_order( order_id ) )
+            {
+                ride_id = r->get_attrib().id;
+                break;
+            }
+        }
+    }   // drop the references before modifying, otherwise the ride would be copied
+
+    if( ride_id == 0 )
     {
-        * error_msg = "no offered rides found for user " + std::to_string( user_id );
+        * error_msg = "no pending order " + std::to_string( order_id ) + " found for user " + std::to_string( user_id );
 
         return false;
     }
 
-    for( auto & r : rides )
-    {
-        if( r->has_pending_order( order_id ) )
-        {
-            r->accept_order( order_id, should_accept );
+    auto r = modify_ride__unlocked( ride_id );
 
-            accept_order_by_id( order_id, should_accept );
+    r->accept_order( order_id, should_accept );
 
-            // decline other pending orders, SKV 19520
+    accept_order_by_id( order_id, should_accept );
 
-            if( should_accept )
-            {
-                std::vector<id_t> pending_order_ids;
+    // decline other pending orders, SKV 19520
 
-                r->get_pending_order_ids( & pending_order_ids );
+    if( should_accept )
+    {
+        std::vector<id_t> pending_order_ids;
 
-                LOG_TRACE( "accept_order: order_id %u, ride_id %u: decline other %u pending order(s)", order_id, r->get_attrib().id, pending_order_ids.size() );
+        r->get_pending_order_ids( & pending_order_ids );
 
-                // decline other pending orders
-                for( auto p : pending_order_ids )
-                {
-                    accept_order_by_id( p, false );
-                }
-            }
+        LOG_TRACE( "accept_order: order_id %u, ride_id %u: decline other %u pending order(s)", order_id, ride_id, pending_order_ids.size() );
 
-            return true;
+        // decline other pending orders
+        for( auto p : pending_order_ids )
+        {
+            accept_order_by_id( p, false );
         }
     }
 
-    * error_msg = "no pending order " + std::to_string( order_id ) + " found for user " + std::to_string( user_id );
-
-    return false;
+    return true;
 }
 
 bool OrderDB::mark_delivered_order( id_t order_id, user_id_t user_id, std::string * error_msg )
@@ -316,9 +476,9 @@ bool OrderDB::mark_delivered_order( id_t order_id, user_id_t user_id, std::strin
 
     MUTEX_SCOPE_LOCK( mutex_ );
 
-    auto ride = find_ride_with_accepted_order_for_user( order_id, user_id );
+    auto ride_id = find_ride_with_accepted_order_for_user( order_id, user_id );
 
-    if( ride == nullptr )
+    if( ride_id == 0 )
     {
         * error_msg = "no ride with accepted order id " + std::to_string( order_id ) + " found for user " + std::to_string( user_id );
 
@@ -334,8 +494,8 @@ bool OrderDB::mark_delivered_order( id_t order_id, user_id_t user_id, std::strin
     switch( raw_order.state )
     {
         case shopndrop_protocol::order_state_e::ACCEPTED_WAITING_DELIVERY:
-            ride->mark_delivered_order();
-            order->mark_delivered_order();
+            modify_ride__unlocked( ride_id )->mark_delivered_order();
+            modify_order__unlocked( order_id )->mark_delivered_order();
             return true;
             break;
         case shopndrop_protocol::order_state_e::DELIVERED_WAITING_FEEDBACK:
@@ -381,7 +541,7 @@ bool OrderDB::rate_shopper( id_t order_id, uint32_t stars, user_id_t user_id, st
             return false;
             break;
         case shopndrop_protocol::order_state_e::DELIVERED_WAITING_FEEDBACK:
-            order->rate_shopper( stars );
+            modify_order__unlocked( order_id )->rate_shopper( stars );
             return true;
             break;
         default:
@@ -392,9 +552,91 @@ bool OrderDB::rate_shopper( id_t order_id, uint32_t stars, user_id_t user_id, st
     return false;
 }
 
-void OrderDB::get_info_for_shopper__unlocked( VectorRide * rides, VectorOrder * orders, user_id_t user_id, std::string * error_msg )
+uint32_t OrderDB::expire_rides()
+{
+    auto now = epoch_now_utc();
+
+    uint32_t res = 0;
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    while( ride_deadlines_.empty() == false && ride_deadlines_.top().first <= now )
+    {
+        auto ride_id = ride_deadlines_.top().second;
+
+        ride_deadlines_.pop();
+
+        std::vector<id_t> pending_order_ids;
+
+        {
+            auto ride = find_ride__unlocked( ride_id );
+
+            // rides with accepted order are closed on delivery
+            if( ride == nullptr || ride->get_ride().is_open == false || ride->get_ride().accepted_order_id != 0 )
+                continue;
+
+            ride->get_pending_order_ids( & pending_order_ids );
+        }
+
+        LOG_TRACE( "expire_rides: ride_id %u, decline %u pending order(s)", ride_id, static_cast<uint32_t>( pending_order_ids.size() ) );
+
+        modify_ride__unlocked( ride_id )->expire();
+
+        for( auto p : pending_order_ids )
+        {
+            accept_order_by_id( p, false );
+        }
+
+        ++res;
+    }
+
+    if( res > 0 )
+        dummy_log_info( MODULENAME, "expired %u ride(s)", res );
+
+    return res;
+}
+
+OrderDB::RidePtr OrderDB::get_ride( id_t ride_id ) const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto it = map_id_to_ride_.find( ride_id );
+
+    if( it == map_id_to_ride_.end() )
+        return RidePtr();
+
+    return it->second;
+}
+
+OrderDB::OrderPtr OrderDB::get_order( id_t order_id ) const
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto it = map_id_to_order_.find( order_id );
+
+    if( it == map_id_to_order_.end() )
+        return OrderPtr();
+
+    return it->second;
+}
+
+OrderDB::ShoppingListPtr OrderDB::get_shopping_list( id_t shopping_list_id ) const
 {
-    LOG_TRACE( "get_info_for_shopper__unlocked: user_id %u", user_id );
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto it = map_id_to_shopping_list_.find( shopping_list_id );
+
+    if( it == map_id_to_shopping_list_.end() )
+        return ShoppingListPtr();
+
+    return it->second;
+}
+
+void OrderDB::get_info_for_shopper( VectorRide * rides, VectorOrder * orders, user_id_t user_id, std::string * error_msg ) const
+{
+    LOG_TRACE( "get_info_for_shopper: user_id %u", user_id );
+
+    MUTEX_SCOPE_LOCK( mutex_ );
 
     find_rides_for_user( rides, user_id, true );
 
@@ -404,38 +646,31 @@ void OrderDB::get_info_for_shopper__unlocked( VectorRide * rides, VectorOrder *
 
         if( raw_ride.accepted_order_id != 0 )
         {
-            auto order = find_order__unlocked( raw_ride.accepted_order_id );
+            auto it = map_id_to_order_.find( raw_ride.accepted_order_id );
 
-            assert( order );
+            assert( it != map_id_to_order_.end() );
 
-            orders->push_back( order );
+            orders->push_back( it->second );
         }
     }
 }
 
-void OrderDB::get_info_for_user__unlocked( VectorRide * rides, VectorOrder * orders, const shopndrop_protocol::GeoPosition & position, user_id_t user_id, std::string * error_msg )
+void OrderDB::get_info_for_user( VectorRide * rides, VectorOrder * orders, const shopndrop_protocol::GeoPosition & position, user_id_t user_id, std::string * error_msg ) const
 {
-    LOG_TRACE( "get_info_for_user__unlocked: position %s, user_id %u", shopndrop_protocol::str_helper::to_string( position ).c_str(), user_id );
+    LOG_TRACE( "get_info_for_user: position %s, user_id %u", shopndrop_protocol::str_helper::to_string( position ).c_str(), user_id );
+
+    MUTEX_SCOPE_LOCK( mutex_ );
 
     find_open_rides_with_unaccepted_orders_near_position( rides, position, user_id );
 
     find_orders_for_user( orders, user_id );
 }
 
-bool OrderDB::get_shopping_info_requests( std::vector<shopndrop_web_protocol::ShoppingRequestInfo> * requests, id_t ride_id, user_id_t user_id, std::string * error_msg )
+void OrderDB::get_shopping_info_requests( std::vector<shopndrop_web_protocol::ShoppingRequestInfo> * requests, const RidePtr & ride, user_id_t user_id ) const
 {
-    LOG_TRACE( "get_shopping_info_requests: ride_id %u, user_id %u", ride_id, user_id );
-
-    MUTEX_SCOPE_LOCK( mutex_ );
-
-    auto ride = find_ride__unlocked( ride_id );
+    auto ride_id = ride->get_attrib().id;
 
-    // do not rely on PermChecker, it only should check permissions, SKV 19517
-    if( ride == nullptr )
-    {
-        * error_msg = "ride " + std::to_string( ride_id ) + " doesn't exist";
-        return false;
-    }
+    LOG_TRACE( "get_shopping_info_requests: ride_id %u, user_id %u", ride_id, user_id );
 
     std::vector<id_t> pending_order_ids;
 
@@ -443,6 +678,10 @@ bool OrderDB::get_shopping_info_requests( std::vector<shopndrop_web_protocol::Sh
 
     LOG_TRACE( "get_shopping_info_requests: ride_id %u: found %u pending orders", ride_id, pending_order_ids.size() );
 
+    requests->reserve( requests->size() + pending_order_ids.size() );
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
     for( auto o : pending_order_ids )
     {
         auto order = find_order__unlocked( o );
@@ -451,14 +690,10 @@ bool OrderDB::get_shopping_info_requests( std::vector<shopndrop_web_protocol::Sh
 
         auto & cache = order->get_cache();
 
-        shopndrop_web_protocol::ShoppingRequestInfo sri;
-
-        shopndrop_web_protocol::initialize( & sri, o, cache.sum, cache.earning, cache.weight, order->get_order().delivery_address );
+        requests->emplace_back();
 
-        requests->push_back( sri );
+        shopndrop_web_protocol::initialize( & requests->back(), o, cache.sum, cache.earning, cache.weight, order->get_order().delivery_address );
     }
-
-    return true;
 }
 
 void OrderDB::init_cache( db::Order::Cache * cache, double sum, double weight, double earning, uint32_t delivery_time, const std::string & shopper_name )
@@ -484,7 +719,7 @@ bool OrderDB::does_fit( const shopndrop_protocol::GeoPosition & positionA, const
     return false;
 }
 
-bool OrderDB::add_shopping_list( id_t id, ShoppingList * shopping_list, user_id_t user_id, std::string * error_msg )
+bool OrderDB::add_shopping_list( id_t id, const ShoppingListPtr & shopping_list, user_id_t user_id, std::string * error_msg )
 {
     LOG_TRACE( "add_shopping_list__unlocked: user_id %u", user_id );
 
@@ -501,7 +736,7 @@ bool OrderDB::add_shopping_list( id_t id, ShoppingList * shopping_list, user_id_
     return true;
 }
 
-bool OrderDB::add_order( id_t id, Order * order, user_id_t user_id, std::string * error_msg )
+bool OrderDB::add_order( id_t id, const std::shared_ptr<Order> & order, user_id_t user_id, std::string * error_msg )
 {
     LOG_TRACE( "add_order__unlocked: user_id %u", user_id );
 
@@ -532,7 +767,7 @@ bool OrderDB::add_pending_order_to_ride( id_t order_id, id_t ride_id, user_id_t
         return false;
     }
 
-    ride->add_pending_order( order_id );
+    modify_ride__unlocked( ride_id )->add_pending_order( order_id );
 
     return true;
 }
@@ -600,7 +835,7 @@ void OrderDB::find_open_rides_with_unaccepted_orders_near_position( VectorRide *
     }
 }
 
-Ride * OrderDB::find_ride_with_accepted_order_for_user( id_t order_id, user_id_t user_id ) const
+id_t OrderDB::find_ride_with_accepted_order_for_user( id_t order_id, user_id_t user_id ) const
 {
     VectorRide temp;
     find_rides_for_user( & temp, user_id, true );
@@ -612,11 +847,11 @@ Ride * OrderDB::find_ride_with_accepted_order_for_user( id_t order_id, user_id_t
         if( ride.is_open )
         {
             if( ride.accepted_order_id == order_id )
-                return r;
+                return r->get_attrib().id;
         }
     }
 
-    return nullptr;
+    return 0;
 }
 
 const Ride * OrderDB::find_ride__unlocked( id_t ride_id ) const
@@ -626,27 +861,59 @@ const Ride * OrderDB::find_ride__unlocked( id_t ride_id ) const
     if( it == map_id_to_ride_.end() )
         return nullptr;
 
-    return it->second;
+    return it->second.get();
+}
+
+const Order * OrderDB::find_order__unlocked( id_t order_id ) const
+{
+    auto it = map_id_to_order_.find( order_id );
+
+    if( it == map_id_to_order_.end() )
+        return nullptr;
+
+    return it->second.get();
 }
 
-Ride * OrderDB::find_ride__unlocked( id_t ride_id )
+Ride * OrderDB::modify_ride__unlocked( id_t ride_id )
 {
     auto it = map_id_to_ride_.find( ride_id );
 
     if( it == map_id_to_ride_.end() )
         return nullptr;
 
-    return it->second;
+    auto & ride = it->second;
+
+    // copy on write: somebody still holds a snapshot of this ride
+    if( ride.use_count() > 1 )
+    {
+        ride = std::make_shared<Ride>( * ride );
+    }
+
+    // synchronize with the release of the last snapshot
+    std::atomic_thread_fence( std::memory_order_acquire );
+
+    return ride.get();
 }
 
-Order * OrderDB::find_order__unlocked( id_t order_id )
+Order * OrderDB::modify_order__unlocked( id_t order_id )
 {
     auto it = map_id_to_order_.find( order_id );
 
     if( it == map_id_to_order_.end() )
         return nullptr;
 
-    return it->second;
+    auto & order = it->second;
+
+    // copy on write: somebody still holds a snapshot of this order
+    if( order.use_count() > 1 )
+    {
+        order = std::make_shared<Order>( * order );
+    }
+
+    // synchronize with the release of the last snapshot
+    std::atomic_thread_fence( std::memory_order_acquire );
+
+    return order.get();
 }
 
 const ShoppingList * OrderDB::find_shopping_list__unlocked( id_t shopping_list_id ) const
@@ -656,7 +923,7 @@ const ShoppingList * OrderDB::find_shopping_list__unlocked( id_t shopping_list_i
     if( it == map_id_to_shopping_list_.end() )
         return nullptr;
 
-    return it->second;
+    return it->second.get();
 }
 
 std::mutex      & OrderDB::get_mutex() const
@@ -28,8 +28,10 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <map>                      // std::map
 #include <set>                      // std::set
 #include <mutex>                    // std::mutex
-#include <memory>                   // std::unique_ptr
+#include <memory>                   // std::shared_ptr
 #include <vector>                   // std::vector
+#include <queue>                    // std::priority_queue
+#include <functional>               // std::greater
 
 #include "shopndrop_web_protocol/protocol.h" // shopndrop_web_protocol::GetRideStatusRequest
 #include "user_manager/user_manager.h"               // user_manager::UserManager
@@ -37,6 +39,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "db_ride.h"                // Ride
 #include "db_order.h"               // Order
 #include "db_shopping_list.h"       // ShoppingList
+#include "id_generator.h"           // IdGenerator
 
 namespace generic_protocol
 {
@@ -53,10 +56,43 @@ public:
     struct Config
     {
         std::string status_file;
+        std::string id_gen_file;
+        uint32_t    id_gen_block_size;
     };
 
-    typedef std::vector< db::Ride* >                VectorRide;
-    typedef std::vector< db::Order* >               VectorOrder;
+    // immutable snapshots, records are copied on write (see modify_ride__unlocked())
+    typedef std::shared_ptr< const db::Ride >       RidePtr;
+    typedef std::shared_ptr< const db::Order >      OrderPtr;
+
+    typedef std::shared_ptr< const db::ShoppingList > ShoppingListPtr;
+
+    typedef std::vector< RidePtr >                  VectorRide;
+    typedef std::vector< OrderPtr >                 VectorOrder;
+
+    struct NewRide
+    {
+        shopndrop_protocol::RideSummary     ride_summary;
+        uint32_t                            delivery_time;
+    };
+
+    struct NewOrder
+    {
+        id_t                                ride_id;
+        shopndrop_web_protocol::ShoppingListWithTotals  shopping_list;
+        shopndrop_protocol::Address         delivery_address;
+        double                              sum;
+        double                              weight;
+        double                              earning;
+        uint32_t                            delivery_time;
+        std::string                         shopper_name;
+    };
+
+    // result of one item of a batch, id is 0 on failure
+    struct BatchResult
+    {
+        id_t                                id;
+        std::string                         error_msg;
+    };
 
 public:
 
@@ -71,7 +107,7 @@ public:
             user_manager::UserManager           * user_man/*,
             ObjGenerator                        * obj_gen */ );
 
-    id_t get_next_id();
+    bool get_next_id( id_t * id, std::string * error_msg );
 
     bool find_user_id_by_order_id( user_id_t * user_id, id_t order_id ) const;
 
@@ -79,7 +115,7 @@ public:
     bool create_and_add_order(
             id_t                * order_id,
             id_t                ride_id,
-            const shopndrop_protocol::ShoppingList & shopping_list,
+            const shopndrop_web_protocol::ShoppingListWithTotals & shopping_list,
             const shopndrop_protocol::Address & delivery_address,
             double              sum,
             double              weight,
@@ -89,47 +125,66 @@ public:
             user_id_t           user_id,
             std::string         * error_msg );
 
+    // all items are added in one critical section, each item succeeds or fails on its own
+    void create_and_add_rides( std::vector<BatchResult> * res, const std::vector<NewRide> & rides, const std::string & shopper_name, user_id_t user_id );
+    void create_and_add_orders( std::vector<BatchResult> * res, const std::vector<NewOrder> & orders, user_id_t user_id );
+
     bool cancel_ride( id_t ride_id, user_id_t user_id, std::string * error_msg );
     bool accept_order( id_t order_id, user_id_t user_id, bool should_accept, std::string * error_msg );
     bool mark_delivered_order( id_t order_id, user_id_t user_id, std::string * error_msg );
     bool rate_shopper( id_t order_id, uint32_t stars, user_id_t user_id, std::string * error_msg );
 
-    void get_info_for_shopper__unlocked( VectorRide * rides, VectorOrder * orders, user_id_t user_id, std::string * error_msg );
-    void get_info_for_user__unlocked( VectorRide * rides, VectorOrder * orders, const shopndrop_protocol::GeoPosition & position, user_id_t user_id, std::string * error_msg );
+    // closes open rides without accepted order whose delivery time has passed, declines their pending orders,
+    // returns the number of expired rides
+    uint32_t expire_rides();
+
+    RidePtr get_ride( id_t ride_id ) const;
+    OrderPtr get_order( id_t order_id ) const;
+    ShoppingListPtr get_shopping_list( id_t shopping_list_id ) const;
+
+    void get_info_for_shopper( VectorRide * rides, VectorOrder * orders, user_id_t user_id, std::string * error_msg ) const;
+    void get_info_for_user( VectorRide * rides, VectorOrder * orders, const shopndrop_protocol::GeoPosition & position, user_id_t user_id, std::string * error_msg ) const;
 
-    bool get_shopping_info_requests( std::vector<shopndrop_web_protocol::ShoppingRequestInfo> * requests, id_t ride_id, user_id_t user_id, std::string * error_msg );
+    // ride is a snapshot resolved by the caller
+    void get_shopping_info_requests( std::vector<shopndrop_web_protocol::ShoppingRequestInfo> * requests, const RidePtr & ride, user_id_t user_id ) const;
 
     const Ride * find_ride__unlocked( id_t ride_id ) const;
-    Ride * find_ride__unlocked( id_t ride_id );
-    Order * find_order__unlocked( id_t order_id );
+    const Order * find_order__unlocked( id_t order_id ) const;
     const ShoppingList * find_shopping_list__unlocked( id_t shopping_list_id ) const;
 
     std::mutex      & get_mutex() const;
 
 private:
 
-    typedef std::map< id_t, db::Ride* >             MapIdToRide;
-    typedef std::map< id_t, db::Order* >            MapIdToOrder;
-    typedef std::map< id_t, db::ShoppingList* >     MapIdToShoppingList;
+    typedef std::map< id_t, std::shared_ptr<db::Ride> >     MapIdToRide;
+    typedef std::map< id_t, std::shared_ptr<db::Order> >    MapIdToOrder;
+    typedef std::map< id_t, ShoppingListPtr >       MapIdToShoppingList;
     typedef std::map< user_id_t, std::set<id_t> >   MapUserIdToOrderIds;
 
+    // delivery time and ride id, earliest first
+    typedef std::pair< uint32_t, id_t >             Deadline;
+    typedef std::priority_queue< Deadline, std::vector<Deadline>, std::greater<Deadline> >  QueueDeadline;
+
 private:
 
-    id_t get_next_id__intern();
+    bool add_ride( id_t ride_id, const std::shared_ptr<Ride> & ride, user_id_t user_id, std::string * error_msg );
+    bool add_shopping_list( id_t shopping_list_id, const ShoppingListPtr & shopping_list, user_id_t user_id, std::string * error_msg );
+    bool add_order( id_t order_id, const std::shared_ptr<Order> & order, user_id_t user_id, std::string * error_msg );
 
-    bool add_ride( id_t ride_id, Ride * ride, user_id_t user_id, std::string * error_msg );
-    bool add_shopping_list( id_t shopping_list_id, ShoppingList * shopping_list, user_id_t user_id, std::string * error_msg );
-    bool add_order( id_t order_id, Order * order, user_id_t user_id, std::string * error_msg );
+    Ride * modify_ride__unlocked( id_t ride_id );
+    Order * modify_order__unlocked( id_t order_id );
 
     void accept_order_by_id( id_t order_id, bool should_accept );
 
     bool add_pending_order_to_ride( id_t order_id, id_t ride_id, user_id_t user_id, std::string * error_msg );
 
+    bool can_add_order_to_ride__unlocked( id_t ride_id, user_id_t user_id, std::string * error_msg ) const;
+
     void find_rides_for_user( VectorRide * res, user_id_t user_id, bool should_user_id_match ) const;
     void find_orders_for_user( VectorOrder * res, user_id_t user_id ) const;
     void find_open_rides_with_unaccepted_orders_for_user( VectorRide * res, user_id_t user_id ) const;
     void find_open_rides_with_unaccepted_orders_near_position( VectorRide * res, const shopndrop_protocol::GeoPosition & position, user_id_t user_id ) const;
-    Ride * find_ride_with_accepted_order_for_user( id_t order_id, user_id_t user_id ) const;
+    id_t find_ride_with_accepted_order_for_user( id_t order_id, user_id_t user_id ) const;
 
     static void init_cache( db::Order::Cache * cache, double sum, double weight, double earning, uint32_t delivery_time, const std::string & shopper_name );
 
@@ -151,12 +206,15 @@ private:
     user_manager::UserManager           * user_man_;
 
     bool                    is_status_loaded_;
-    id_t                    last_order_id_;
+
+    IdGenerator             id_gen_;    // doesn't need mutex_
 
     MapIdToRide             map_id_to_ride_;
     MapIdToOrder            map_id_to_order_;
     MapIdToShoppingList     map_id_to_shopping_list_;
     MapUserIdToOrderIds     map_user_id_to_order_id_;
+
+    QueueDeadline           ride_deadlines_;
 };
 
 } // namespace db
@@ -90,12 +90,7 @@ bool Ride::has_pending_order( id_t order_id ) const
 
 void Ride::get_pending_order_ids( std::vector<id_t> * pending_order_ids ) const
 {
-    pending_order_ids->clear();
-
-    for( auto & e : pending_order_ids_ )
-    {
-        pending_order_ids->push_back( e );
-    }
+    pending_order_ids->assign( pending_order_ids_.begin(), pending_order_ids_.end() );
 }
 
 void Ride::accept_order( id_t order_id, bool should_accept )
@@ -136,6 +131,19 @@ void Ride::cancel_ride()
     ride_.resolution    = shopndrop_protocol::ride_resolution_e::CANCELLED;
 }
 
+void Ride::expire()
+{
+    LOGI_INFO( "expire: num of pending orders %u", pending_order_ids_.size() );
+
+    assert( ride_.is_open );
+    assert( ride_.accepted_order_id == 0 );
+
+    pending_order_ids_.clear();
+
+    ride_.is_open       = false;
+    ride_.resolution    = shopndrop_protocol::ride_resolution_e::EXPIRED_OR_COMPLETED;
+}
+
 uint32_t Ride::get_log_id() const
 {
     return log_id_;
@@ -62,6 +62,7 @@ public:
     void accept_order( id_t order_id, bool should_accept );
     void mark_delivered_order();
     void cancel_ride();
+    void expire();
 
 private:
 
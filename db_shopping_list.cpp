@@ -27,13 +27,18 @@ namespace shopndrop {
 
 namespace db {
 
-ShoppingList::ShoppingList( id_t id, user_id_t user_id, const shopndrop_protocol::ShoppingList & shopping_list ):
+ShoppingList::ShoppingList( id_t id, user_id_t user_id, const shopndrop_web_protocol::ShoppingListWithTotals & shopping_list ):
         attrib_( id, user_id ),
         shopping_list_( shopping_list )
 {
 }
 
-const shopndrop_protocol::ShoppingList & ShoppingList::get_shopping_list() const
+const ObjAttribution & ShoppingList::get_attrib() const
+{
+    return attrib_;
+}
+
+const shopndrop_web_protocol::ShoppingListWithTotals & ShoppingList::get_shopping_list() const
 {
     return shopping_list_;
 }
@@ -24,7 +24,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #ifndef SHOPNDROP__DB_SHOPPING_LIST_H
 #define SHOPNDROP__DB_SHOPPING_LIST_H
 
-#include "shopndrop_protocol/protocol.h"     // shopndrop_protocol::ShoppingList
+#include "shopndrop_web_protocol/protocol.h" // shopndrop_web_protocol::ShoppingListWithTotals
 #include "db_obj_attribution.h"     // ObjAttribution
 
 namespace shopndrop {
@@ -34,15 +34,18 @@ namespace db {
 class ShoppingList
 {
 public:
-    ShoppingList( id_t id, user_id_t user_id, const shopndrop_protocol::ShoppingList & shopping_list );
+    ShoppingList( id_t id, user_id_t user_id, const shopndrop_web_protocol::ShoppingListWithTotals & shopping_list );
 
-    const shopndrop_protocol::ShoppingList & get_shopping_list() const;
+    const ObjAttribution & get_attrib() const;
+
+    // items with product data and prices frozen at the time of the order
+    const shopndrop_web_protocol::ShoppingListWithTotals & get_shopping_list() const;
 
 private:
 
     ObjAttribution  attrib_;
 
-    shopndrop_protocol::ShoppingList    shopping_list_;
+    shopndrop_web_protocol::ShoppingListWithTotals  shopping_list_;
 };
 
 } // namespace db
@@ -25,6 +25,13 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <thread>                           // std::thread
 #include <functional>                       // std::bind
 #include <vector>                           // std::vector
+#include <csignal>                          // sigset_t
+#include <pthread.h>                        // pthread_sigmask
+#include <sys/signalfd.h>                   // signalfd
+#include <sys/eventfd.h>                    // eventfd
+#include <poll.h>                           // poll
+#include <unistd.h>                         // read, write, close
+#include <cerrno>                           // errno
 
 #include "utils/dummy_logger.h"             // dummy_log_set_log_level
 #include "utils/logfile_time_writer.h"      // utils::LogfileTimeWriter
@@ -36,39 +43,119 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "user_reg/init_config.h"           // user_reg::init_config
 #include "user_reg_email/init_config.h"     // user_reg_email::init_config
 #include "scheduler/scheduler.h"            // Scheduler
-#include "scheduler/periodic_job_aux.h"     // scheduler::create_and_insert_periodic_job
 #include "threcon/controller.h"             // Controller
-#include "daemons/signal_poller.h"          // SignalPoller
 #include "config_reader/config_reader.h"    // config_reader::ConfigReader
 
 #include "core.h"
 #include "config_extractor.h"               // init_config
 
-void check_signals( threcon::Controller * controller )
+/**
+ * @brief Handles TERM, INT and HUP in a thread of its own, the thread sleeps until a signal arrives.
+ *
+ * The thread is woken up and joined by stop() or the destructor, so it doesn't outlive main on any exit path.
+ */
+class SignalThread
 {
-    if( daemons::SignalPoller::poll_term() || daemons::SignalPoller::poll_int() )
-        controller->send_shutdown();
+public:
 
-    if( daemons::SignalPoller::poll_hup() )
-        return;
-}
+    SignalThread():
+        signal_fd_( -1 ),
+        wake_fd_( -1 )
+    {
+    }
 
-void init_check_signals(
-        scheduler::IScheduler   & sched,
-        threcon::Controller     * controller )
-{
-    scheduler::job_id_t job_id;
-    std::string         error_msg;
+    ~SignalThread()
+    {
+        stop();
 
-    auto now = scheduler::get_now();
+        if( signal_fd_ >= 0 )
+            close( signal_fd_ );
 
-    scheduler::Time     exec_time   = now + std::chrono::seconds( 1 );
-    scheduler::Duration period      = std::chrono::milliseconds( 10 );
+        if( wake_fd_ >= 0 )
+            close( wake_fd_ );
+    }
 
-    scheduler::create_and_insert_periodic_job(
-                & job_id, & error_msg, sched, "check_signals", exec_time, period,
-                std::bind( & check_signals, controller ) );
-}
+    // blocks the signals in the calling thread, must be called before any other thread is started,
+    // so that all of them inherit the blocked mask and the signals are delivered via the descriptor only
+    bool init()
+    {
+        sigset_t mask;
+
+        sigemptyset( & mask );
+        sigaddset( & mask, SIGTERM );
+        sigaddset( & mask, SIGINT );
+        sigaddset( & mask, SIGHUP );
+
+        if( pthread_sigmask( SIG_BLOCK, & mask, nullptr ) != 0 )
+            return false;
+
+        signal_fd_  = signalfd( -1, & mask, SFD_CLOEXEC );
+        wake_fd_    = eventfd( 0, EFD_CLOEXEC );
+
+        return signal_fd_ >= 0 && wake_fd_ >= 0;
+    }
+
+    void start( threcon::Controller * controller, shopndrop::Core * core )
+    {
+        thread_ = std::thread( std::bind( & SignalThread::thread_func, this, controller, core ) );
+    }
+
+    void stop()
+    {
+        if( thread_.joinable() == false )
+            return;
+
+        uint64_t v = 1;
+
+        auto n = write( wake_fd_, & v, sizeof( v ) );
+
+        ( void )n;
+
+        thread_.join();
+    }
+
+private:
+
+    void thread_func( threcon::Controller * controller, shopndrop::Core * core )
+    {
+        while( true )
+        {
+            pollfd fds[2] = { { signal_fd_, POLLIN, 0 }, { wake_fd_, POLLIN, 0 } };
+
+            auto res = poll( fds, 2, -1 );
+
+            if( res < 0 && errno == EINTR )
+                continue;
+
+            // stopped by main, shutdown is already in progress
+            if( res > 0 && ( fds[1].revents & POLLIN ) )
+                break;
+
+            signalfd_siginfo si;
+
+            auto n = ( res > 0 ) ? read( signal_fd_, & si, sizeof( si ) ) : -1;
+
+            if( n < 0 && errno == EINTR )
+                continue;
+
+            if( n == static_cast<ssize_t>( sizeof( si ) ) && si.ssi_signo == SIGHUP )
+            {
+                core->reload_goodies_db();
+                continue;
+            }
+
+            controller->send_shutdown();
+            break;
+        }
+    }
+
+private:
+
+    int             signal_fd_;
+    int             wake_fd_;       // wakes up the thread on stop()
+
+    std::thread     thread_;
+};
 
 int main( int argc, char **argv )
 {
@@ -167,9 +254,22 @@ int main( int argc, char **argv )
             dummy_log_info( log_id_main, "contining without daemon" );
         }
 
+        // in the daemonized process and before any threads are started, so that all of them inherit the blocked mask
+        SignalThread signal_thread;
+
+        if( signal_thread.init() == false )
+        {
+            std::cerr << "cannot init signal handling" << std::endl;
+            dummy_log_fatal( log_id_main, "cannot init signal handling" );
+
+            return EXIT_FAILURE;
+        }
+
         http_server.init( server_config, log_id_http_server, core.get_http_handler() );
 
-        core.init(
+        std::string error_msg;
+
+        if( core.init(
                 core_config, sesman_cfg,
                 user_reg_config,
                 user_reg_email_config,
@@ -177,9 +277,14 @@ int main( int argc, char **argv )
                 log_id_core_handler,
                 log_id_ride,
                 log_id_order,
-                &sched );
+                &sched,
+                & error_msg ) == false )
+        {
+            std::cerr << "cannot init core: " << error_msg << std::endl;
+            dummy_log_fatal( log_id_main, "cannot init core: %s", error_msg.c_str() );
 
-        init_check_signals( sched, & controller );
+            return EXIT_FAILURE;
+        }
 
         controller.register_client( & http_server );
 
@@ -187,12 +292,17 @@ int main( int argc, char **argv )
 
         tg.push_back( std::thread( std::bind( &threcon::Controller::thread_func, &controller ) ) );
 
+        signal_thread.start( & controller, & core );
+
         sched.run();
         http_server.start();
 
         for( auto & t : tg )
             t.join();
 
+        // the controller may have been shut down without a signal
+        signal_thread.stop();
+
         sched.shutdown();
 
         core.shutdown();
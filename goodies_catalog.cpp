@@ -0,0 +1,464 @@
+/*
+
+Goodies Catalog.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "goodies_catalog.h"            // self
+
+#include <fstream>                      // std::ifstream
+#include <algorithm>                    // std::sort
+#include <cstdlib>                      // strtoul, strtod
+#include <cmath>                        // std::isfinite
+#include <cerrno>                       // errno
+#include <cctype>                       // isdigit
+
+namespace shopndrop {
+
+const uint32_t GoodiesCatalog::NO_INDEX;
+
+GoodiesCatalog::GoodiesCatalog()
+{
+}
+
+bool GoodiesCatalog::load( const std::string & filename, std::string * error_msg )
+{
+    std::ifstream is( filename );
+
+    if( is.is_open() == false )
+    {
+        * error_msg = "cannot open " + filename;
+        return false;
+    }
+
+    if( load( is, error_msg ) == false )
+    {
+        * error_msg = filename + ": " + * error_msg;
+        return false;
+    }
+
+    return true;
+}
+
+bool GoodiesCatalog::load( std::istream & is, std::string * error_msg )
+{
+    struct Entry
+    {
+        id_t                            id;
+        shopndrop_protocol::ProductItem product_item;
+        std::string                     category;
+    };
+
+    static const char   TRAILER[]       = "#END;";
+    static const size_t TRAILER_LEN     = sizeof( TRAILER ) - 1;
+
+    std::vector<Entry>  entries;
+
+    std::string line;
+    uint32_t    line_num = 0;
+    bool        has_trailer = false;
+
+    while( std::getline( is, line ) )
+    {
+        ++line_num;
+
+        if( line.empty() == false && line.back() == '\r' )
+            line.pop_back();
+
+        if( line.empty() )
+            continue;
+
+        if( has_trailer )
+        {
+            * error_msg = "line " + std::to_string( line_num ) + ": unexpected data after trailer";
+            return false;
+        }
+
+        if( line.compare( 0, TRAILER_LEN, TRAILER ) == 0 )
+        {
+            if( parse_trailer( entries.size(), line.substr( TRAILER_LEN ), error_msg ) == false )
+            {
+                * error_msg = "line " + std::to_string( line_num ) + ": " + * error_msg;
+                return false;
+            }
+
+            has_trailer = true;
+            continue;
+        }
+
+        if( line[0] == '#' )
+            continue;
+
+        entries.emplace_back();
+
+        auto & e = entries.back();
+
+        if( parse_line( & e.id, & e.product_item, & e.category, line, error_msg ) == false )
+        {
+            * error_msg = "line " + std::to_string( line_num ) + ": " + * error_msg;
+            return false;
+        }
+    }
+
+    // a truncated file would otherwise be taken for a smaller catalog
+    if( has_trailer == false )
+    {
+        * error_msg = "trailer '" + std::string( TRAILER ) + "<number of items>' not found, file is incomplete";
+        return false;
+    }
+
+    std::sort( entries.begin(), entries.end(),
+            []( const Entry & a, const Entry & b ) { return a.id < b.id; } );
+
+    ids_.clear();
+    product_items_.clear();
+    prices_.clear();
+    weights_.clear();
+    category_to_ranges_.clear();
+
+    ids_.reserve( entries.size() );
+    product_items_.reserve( entries.size() );
+    prices_.reserve( entries.size() );
+    weights_.reserve( entries.size() );
+
+    for( auto & e : entries )
+    {
+        if( ids_.empty() == false && ids_.back() == e.id )
+        {
+            * error_msg = "duplicate product item id " + std::to_string( e.id );
+            return false;
+        }
+
+        // items without category are listed only as part of all items
+        if( e.category.empty() == false )
+        {
+            auto index = static_cast<uint32_t>( ids_.size() );
+
+            auto & category = category_to_ranges_[ e.category ];
+
+            if( category.ranges.empty() == false && category.ranges.back().second == index )
+                ++category.ranges.back().second;
+            else
+                category.ranges.emplace_back( index, index + 1 );
+
+            ++category.size;
+        }
+
+        ids_.push_back( e.id );
+        prices_.push_back( e.product_item.price );
+        weights_.push_back( e.product_item.weight );
+        product_items_.push_back( { e.id, std::move( e.product_item ) } );
+    }
+
+    init_index();
+
+    init_search_index();
+
+    return true;
+}
+
+bool GoodiesCatalog::parse_line( id_t * id, shopndrop_protocol::ProductItem * product_item, std::string * category, const std::string & line, std::string * error_msg )
+{
+    static const unsigned MIN_NUM_FIELDS    = 5;
+    static const unsigned NUM_FIELDS        = 6;
+
+    std::string fields[NUM_FIELDS];
+
+    unsigned    i       = 0;
+    size_t      start   = 0;
+
+    while( true )
+    {
+        auto pos = line.find( ';', start );
+
+        if( i == NUM_FIELDS )
+        {
+            * error_msg = "too many fields";
+            return false;
+        }
+
+        fields[i++] = line.substr( start, pos == std::string::npos ? std::string::npos : pos - start );
+
+        if( pos == std::string::npos )
+            break;
+
+        start = pos + 1;
+    }
+
+    if( i < MIN_NUM_FIELDS )
+    {
+        * error_msg = "expected at least " + std::to_string( MIN_NUM_FIELDS ) + " fields, got " + std::to_string( i );
+        return false;
+    }
+
+    char * end = nullptr;
+
+    errno   = 0;
+
+    auto v = strtoul( fields[0].c_str(), & end, 10 );
+
+    // strtoul accepts leading spaces and signs and wraps negative values around
+    if( fields[0].empty() || isdigit( static_cast<unsigned char>( fields[0][0] ) ) == 0 || * end != '\0' || errno == ERANGE || v == 0 || v > 0xFFFFFFFF )
+    {
+        * error_msg = "invalid id '" + fields[0] + "'";
+        return false;
+    }
+
+    if( fields[1].empty() )
+    {
+        * error_msg = "empty name";
+        return false;
+    }
+
+    errno   = 0;
+
+    double price    = strtod( fields[3].c_str(), & end );
+
+    if( fields[3].empty() || * end != '\0' || errno == ERANGE || std::isfinite( price ) == false || price < 0 )
+    {
+        * error_msg = "invalid price '" + fields[3] + "'";
+        return false;
+    }
+
+    errno   = 0;
+
+    double weight   = strtod( fields[4].c_str(), & end );
+
+    if( fields[4].empty() || * end != '\0' || errno == ERANGE || std::isfinite( weight ) == false || weight < 0 )
+    {
+        * error_msg = "invalid weight '" + fields[4] + "'";
+        return false;
+    }
+
+    * id            = static_cast<id_t>( v );
+    * product_item  = { fields[1], fields[2], price, weight };
+    * category      = fields[5];
+
+    return true;
+}
+
+bool GoodiesCatalog::parse_trailer( size_t num_items, const std::string & s, std::string * error_msg )
+{
+    char * end = nullptr;
+
+    errno   = 0;
+
+    auto v = strtoul( s.c_str(), & end, 10 );
+
+    if( s.empty() || isdigit( static_cast<unsigned char>( s[0] ) ) == 0 || * end != '\0' || errno == ERANGE )
+    {
+        * error_msg = "invalid trailer '" + s + "'";
+        return false;
+    }
+
+    if( v != num_items )
+    {
+        * error_msg = "trailer expects " + s + " product items, found " + std::to_string( num_items );
+        return false;
+    }
+
+    return true;
+}
+
+void GoodiesCatalog::init_index()
+{
+    static const uint32_t MAX_SPARSENESS    = 4;
+    static const uint32_t MIN_TABLE_SIZE    = 1024;
+
+    id_to_index_.clear();
+
+    if( ids_.empty() )
+        return;
+
+    auto max_id = ids_.back();
+
+    // use direct lookup only if the table doesn't get too sparse, otherwise fall back to binary search
+    if( max_id >= MAX_SPARSENESS * ids_.size() + MIN_TABLE_SIZE )
+        return;
+
+    id_to_index_.assign( max_id + 1, NO_INDEX );
+
+    for( uint32_t i = 0; i < ids_.size(); ++i )
+    {
+        id_to_index_[ ids_[i] ] = i;
+    }
+}
+
+void GoodiesCatalog::init_search_index()
+{
+    search_index_.clear();
+
+    for( uint32_t i = 0; i < product_items_.size(); ++i )
+    {
+        auto & product_item = product_items_[i].product_item;
+
+        search_index_.add( i, product_item.name, product_item.unit );
+    }
+
+    search_index_.finalize();
+}
+
+uint32_t GoodiesCatalog::find_index( id_t id ) const
+{
+    if( id_to_index_.empty() == false )
+    {
+        if( id >= id_to_index_.size() )
+            return NO_INDEX;
+
+        return id_to_index_[ id ];
+    }
+
+    auto it = std::lower_bound( ids_.begin(), ids_.end(), id );
+
+    if( it == ids_.end() || * it != id )
+        return NO_INDEX;
+
+    return static_cast<uint32_t>( it - ids_.begin() );
+}
+
+const shopndrop_protocol::ProductItem * GoodiesCatalog::find_product_item( id_t id ) const
+{
+    auto i = find_index( id );
+
+    if( i == NO_INDEX )
+        return nullptr;
+
+    return & product_items_[ i ].product_item;
+}
+
+const std::vector<shopndrop_web_protocol::ProductItemWithId> & GoodiesCatalog::get_all_product_items() const
+{
+    return product_items_;
+}
+
+bool GoodiesCatalog::convert_to_detailed( shopndrop_web_protocol::ShoppingListWithProduct * res, double * price, double * weight, const shopndrop_protocol::ShoppingList & shopping_list, std::string * error_msg ) const
+{
+    double p = 0;
+    double w = 0;
+
+    res->items.reserve( res->items.size() + shopping_list.items.size() );
+
+    for( auto & e : shopping_list.items )
+    {
+        auto i = find_index( e.product_item_id );
+
+        if( i == NO_INDEX )
+        {
+            * error_msg = "invalid product item id " + std::to_string( e.product_item_id );
+            return false;
+        }
+
+        res->items.emplace_back();
+
+        auto & si = res->items.back();
+
+        si.product_item     = product_items_[i].product_item;
+        si.shopping_item    = e;
+
+        p += prices_[i] * e.amount;
+        w += weights_[i] * e.amount;
+    }
+
+    * price    = p;
+    * weight   = w;
+
+    return true;
+}
+
+void GoodiesCatalog::add_product_items( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, uint32_t begin, uint32_t end ) const
+{
+    res->insert( res->end(), product_items_.begin() + begin, product_items_.begin() + end );
+}
+
+uint32_t GoodiesCatalog::get_product_items( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, const std::string & category, uint32_t offset, uint32_t limit ) const
+{
+    if( category.empty() )
+    {
+        auto total  = static_cast<uint32_t>( ids_.size() );
+
+        if( offset < total )
+        {
+            auto end = offset + std::min( limit, total - offset );
+
+            res->reserve( res->size() + end - offset );
+
+            add_product_items( res, offset, end );
+        }
+
+        return total;
+    }
+
+    auto it = category_to_ranges_.find( category );
+
+    if( it == category_to_ranges_.end() )
+        return 0;
+
+    auto & c = it->second;
+
+    if( offset >= c.size )
+        return c.size;
+
+    res->reserve( res->size() + std::min( limit, c.size - offset ) );
+
+    // skip whole ranges until the offset is reached, then copy until the limit is exhausted
+    for( auto & r : c.ranges )
+    {
+        if( limit == 0 )
+            break;
+
+        auto size = r.second - r.first;
+
+        if( offset >= size )
+        {
+            offset -= size;
+            continue;
+        }
+
+        auto n = std::min( limit, size - offset );
+
+        add_product_items( res, r.first + offset, r.first + offset + n );
+
+        limit   -= n;
+        offset  = 0;
+    }
+
+    return c.size;
+}
+
+uint32_t GoodiesCatalog::search( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, const std::string & query, uint32_t offset, uint32_t limit ) const
+{
+    std::vector<uint32_t> indices;
+
+    auto total = search_index_.search( & indices, query, offset, limit );
+
+    res->reserve( res->size() + indices.size() );
+
+    for( auto i : indices )
+    {
+        res->push_back( product_items_[i] );
+    }
+
+    return total;
+}
+
+uint32_t GoodiesCatalog::get_size() const
+{
+    return static_cast<uint32_t>( ids_.size() );
+}
+
+} // namespace shopndrop
@@ -0,0 +1,116 @@
+/*
+
+Goodies Catalog.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHOPNDROP__GOODIES_CATALOG_H
+#define SHOPNDROP__GOODIES_CATALOG_H
+
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+#include <map>                      // std::map
+#include <istream>                  // std::istream
+
+#include "shopndrop_web_protocol/protocol.h" // shopndrop_protocol::ProductItem
+
+#include "types.h"                  // id_t
+#include "goodies_search_index.h"   // GoodiesSearchIndex
+
+namespace shopndrop {
+
+/**
+ * @brief Product items kept in a dense table sorted by id.
+ *
+ * File format, one product per line:
+ *
+ * id;name;unit;price;weight[;category]
+ *
+ * The last line must be the trailer "#END;<number of items>", so that a truncated file is detected.
+ * Empty lines and other lines starting with '#' are ignored.
+ * Items without category are not part of any category.
+ */
+class GoodiesCatalog
+{
+public:
+
+    GoodiesCatalog();
+
+    bool load( const std::string & filename, std::string * error_msg );
+    bool load( std::istream & is, std::string * error_msg );
+
+    const shopndrop_protocol::ProductItem * find_product_item( id_t id ) const;
+
+    // valid as long as the catalog exists
+    const std::vector<shopndrop_web_protocol::ProductItemWithId> & get_all_product_items() const;
+
+    // validates the list, copies the product data and sums up price and weight in one pass
+    bool convert_to_detailed( shopndrop_web_protocol::ShoppingListWithProduct * res, double * price, double * weight, const shopndrop_protocol::ShoppingList & shopping_list, std::string * error_msg ) const;
+
+    // returns the total number of items in the category ("" - all items), fills res with the items [offset, offset + limit)
+    uint32_t get_product_items( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, const std::string & category, uint32_t offset, uint32_t limit ) const;
+
+    // word prefix search over name and unit, returns the total number of matches
+    uint32_t search( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, const std::string & query, uint32_t offset, uint32_t limit ) const;
+
+    uint32_t get_size() const;
+
+private:
+
+    static bool parse_line( id_t * id, shopndrop_protocol::ProductItem * product_item, std::string * category, const std::string & line, std::string * error_msg );
+    static bool parse_trailer( size_t num_items, const std::string & s, std::string * error_msg );
+
+    void init_index();
+
+    void init_search_index();
+
+    void add_product_items( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, uint32_t begin, uint32_t end ) const;
+
+    uint32_t find_index( id_t id ) const;
+
+private:
+
+    static const uint32_t   NO_INDEX        = 0xFFFFFFFF;
+
+    std::vector<id_t>                               ids_;           // sorted
+    std::vector<shopndrop_web_protocol::ProductItemWithId>  product_items_; // same order as ids_, kept ready for the list response
+
+    std::vector<double>                             prices_;        // same order as ids_, for pricing
+    std::vector<double>                             weights_;       // same order as ids_, for pricing
+
+    std::vector<uint32_t>                           id_to_index_;   // direct lookup, only if ids are dense
+
+    GoodiesSearchIndex                              search_index_;
+
+    // ranges [first, second) of indices, adjacent items of the same category are merged into one range
+    typedef std::vector<std::pair<uint32_t,uint32_t>>   VectorRange;
+
+    struct Category
+    {
+        Category(): size( 0 ) {}
+
+        VectorRange ranges;
+        uint32_t    size;
+    };
+
+    std::map<std::string, Category>                 category_to_ranges_;
+};
+
+} // namespace shopndrop
+
+#endif // SHOPNDROP__GOODIES_CATALOG_H
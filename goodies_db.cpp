@@ -23,20 +23,21 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "goodies_db.h"                 // self
 
-#include <fstream>                      // std::ofstream
-#include <sstream>                      // std::ostringstream
-#include <algorithm>                    // std::sort
-
 #include "utils/mutex_helper.h"      // MUTEX_SCOPE_LOCK
 #include "utils/dummy_logger.h"      // dummy_log
 #include "utils/utils_assert.h"      // ASSERT
 
+#include <sys/stat.h>                   // stat
+
 
 #define MODULENAME      "GoodiesDB"
 
 namespace shopndrop {
 
-GoodiesDB::GoodiesDB()
+GoodiesDB::GoodiesDB():
+    db_file_mtime_( 0 ),
+    version_( 0 ),
+    catalog_( std::make_shared<GoodiesCatalog>() )
 {
 }
 
@@ -51,7 +52,7 @@ bool GoodiesDB::init(
 
     db_file_    = db_file;
 
-    if( load() == false )
+    if( load( true ) == false )
         return false;
 
 //    is_status_loaded_   = true;
@@ -59,137 +60,116 @@ bool GoodiesDB::init(
     return true;
 }
 
-bool GoodiesDB::load()
+bool GoodiesDB::reload()
 {
-    map_id_to_product_item_ =
-    {
-            { 13, { "Kaffee Auslese",           "Packung",  5.79, 0.5 } },
-            { 14, { "Dallmayr Kaffee",          "Packung",  6.29, 0.5 } },
-            { 15, { "Bärenmarke Kondensmilch",  "Dose",     0.89, 0.34 } },
-            { 16, { "Jacobs Gold",              "Dose",     7.49, 0.2 } },
-            { 17, { "Nescafe Classic",          "Dose",     4.39, 0.1 } },
-            { 21, { "Brot",                     "Stück",    1.49, 0.5 } },
-            { 22, { "Roggenvollkornbrot",       "Stück",    0.79, 0.5 } },
-            { 23, { "Sonnenkernbrot",           "Stück",    1.39, 0.5 } },
-            { 31, { "Apfel",                    "kg",       2.49, 1.5 } },
-            { 32, { "Gurke",                    "Stück",    0.49, 0.2 } },
-            { 33, { "Banane",                   "Stück",    0.89, 0.2 } },
-            { 34, { "Paprika Rot",              "Packung",  1.59, 0.5 } },
-            { 35, { "Karotten",                 "Schale",   1.69, 1.0 } },
-            { 36, { "Tomaten",                  "Packung",  2.79, 0.5 } },
-            { 37, { "Orangen",                  "Netz",     1.99, 2.0 } },
-            { 41, { "Nutella",                  "Dose",     1.99, 0.3 } },
-            { 42, { "Corny Riegel",             "Riegel",   1.59, 0.15 } },
-            { 43, { "Haribo Color-Rado",        "Packung",  1.19, 0.36 } },
-            { 44, { "Ritter Sport Voll-Nuss",   "Tafel",    1.49, 0.1 } },
-            { 45, { "Ritter Sport Marzipan",    "Tafel",    1.19, 0.1 } },
-            { 46, { "Milka Alpenmilch",         "Tafel",    0.99, 0.1 } },
-            { 50, { "Spaghetti",                "Packung",  0.79, 0.5 } },
-            { 60, { "Erdnüsse",                 "Packung",  1.79, 0.125 } },
-            { 71, { "Milch",                    "Packung",  1.09, 1.0 } },
-            { 72, { "Käse Gouda jung",          "Packung",  2.06, 0.4 } },
-            { 73, { "Käseaufschnitt",           "Packung",  1.39, 0.25 } },
-            { 74, { "Süssrahmbutter",           "Packung",  2.49, 0.25 } },
-    };
+    MUTEX_SCOPE_LOCK( mutex_ );
 
-    return true;
+    dummy_log_info( MODULENAME, "reload" );
+
+    // explicit reload, the operator may well have removed products
+    return load( true );
 }
 
-std::vector<shopndrop_web_protocol::ProductItemWithId> GoodiesDB::get_all_product_items() const
+bool GoodiesDB::reload_if_changed()
 {
-    std::vector<shopndrop_web_protocol::ProductItemWithId> res;
+    MUTEX_SCOPE_LOCK( mutex_ );
 
-    for( auto & e : map_id_to_product_item_ )
-    {
-        res.push_back( { e.first, e.second } );
-    }
+    time_t mtime;
 
-    return res;
-}
+    if( get_db_file_mtime( & mtime ) == false || mtime == db_file_mtime_ )
+        return false;
 
-const shopndrop_protocol::ProductItem * GoodiesDB::find_product_item( id_t id ) const
-{
-    MUTEX_SCOPE_LOCK( mutex_ );
+    dummy_log_info( MODULENAME, "%s has changed, reloading", db_file_.c_str() );
 
-    return find_product_item__unlocked( id );
+    return load( false );
 }
 
-const shopndrop_protocol::ProductItem * GoodiesDB::find_product_item__unlocked( id_t id ) const
+bool GoodiesDB::load( bool is_shrink_allowed )
 {
-    auto it = map_id_to_product_item_.find( id );
+    // private: mutex must be locked
 
-    if( it == map_id_to_product_item_.end() )
-        return nullptr;
+    auto catalog = std::make_shared<GoodiesCatalog>();
 
-    return & it->second;
-}
+    std::string     error_msg;
 
-bool GoodiesDB::validate( const shopndrop_protocol::ShoppingList & shopping_list, std::string * error_msg )
-{
-    MUTEX_SCOPE_LOCK( mutex_ );
+    time_t mtime_before = 0;
+
+    get_db_file_mtime( & mtime_before );
+
+    auto b = catalog->load( db_file_, & error_msg );
+
+    time_t mtime_after  = 0;
 
-    for( auto & e : shopping_list.items )
+    get_db_file_mtime( & mtime_after );
+
+    // the file is still being written, db_file_mtime_ is left as is, so that the next check loads it again
+    if( mtime_after != mtime_before )
     {
-        auto product_item = find_product_item__unlocked( e.product_item_id );
+        dummy_log_warn( MODULENAME, "%s has changed during loading, keeping the current catalog", db_file_.c_str() );
 
-        if( product_item == nullptr )
-        {
-            * error_msg = "invalid product item id " + std::to_string( e.product_item_id );
-            return false;
-        }
+        return false;
     }
 
-    return true;
-}
+    // a broken file is not loaded again until it changes
+    db_file_mtime_  = mtime_after;
 
-void GoodiesDB::calculate_price_weight( const shopndrop_protocol::ShoppingList & shopping_list, double * price, double * weight )
-{
-    MUTEX_SCOPE_LOCK( mutex_ );
+    if( b == false )
+    {
+        dummy_log_error( MODULENAME, "cannot load catalog, keeping the current one: %s", error_msg.c_str() );
 
-    double p = 0;
-    double w = 0;
+        return false;
+    }
 
-    for( auto & e : shopping_list.items )
-    {
-        auto product_item = find_product_item__unlocked( e.product_item_id );
+    auto current_size = get_catalog()->get_size();
 
-        assert( product_item != nullptr );
+    if( is_shrink_allowed == false && catalog->get_size() < current_size * MIN_RELOAD_SIZE_PERCENT / 100 )
+    {
+        dummy_log_error( MODULENAME, "catalog would shrink from %u to %u product items, keeping the current one, use explicit reload to apply it",
+                current_size, catalog->get_size() );
 
-        p += product_item->price * e.amount;
-        w += product_item->weight * e.amount;
+        return false;
     }
 
-    * price     = p;
-    * weight    = w;
-}
+    // readers which already hold the old snapshot keep using it until they release it
+    std::atomic_store( & catalog_, CatalogPtr( catalog ) );
 
+    auto version = ++version_;
 
-void GoodiesDB::convert_to_detailed( shopndrop_web_protocol::ShoppingListWithProduct * res, double * price, double * weight, const shopndrop_protocol::ShoppingList & shopping_list )
-{
-    MUTEX_SCOPE_LOCK( mutex_ );
+    dummy_log_info( MODULENAME, "loaded %u product items from %s, version %u", catalog->get_size(), db_file_.c_str(), version );
 
-    double p = 0;
-    double w = 0;
+    return true;
+}
 
-    for( auto & e : shopping_list.items )
-    {
-        auto product_item = find_product_item__unlocked( e.product_item_id );
+bool GoodiesDB::get_db_file_mtime( time_t * mtime ) const
+{
+    struct stat st;
 
-        assert( product_item != nullptr );
+    if( stat( db_file_.c_str(), & st ) != 0 )
+        return false;
 
-        shopndrop_web_protocol::ShoppingItemWithProduct si;
+    * mtime = st.st_mtime;
 
-        si.product_item     = * product_item;
-        si.shopping_item    = e;
+    return true;
+}
 
-        res->items.push_back( si );
+GoodiesDB::CatalogPtr GoodiesDB::get_catalog() const
+{
+    return std::atomic_load( & catalog_ );
+}
 
-        p += product_item->price * e.amount;
-        w += product_item->weight * e.amount;
-    }
+uint32_t GoodiesDB::get_product_items( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, const std::string & category, uint32_t offset, uint32_t limit ) const
+{
+    return get_catalog()->get_product_items( res, category, offset, limit );
+}
+
+uint32_t GoodiesDB::search( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, const std::string & query, uint32_t offset, uint32_t limit ) const
+{
+    return get_catalog()->search( res, query, offset, limit );
+}
 
-    * price    = p;
-    * weight   = w;
+uint32_t GoodiesDB::get_version() const
+{
+    return version_;
 }
 
 } // namespace shopndrop
@@ -25,14 +25,16 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #define SHOPNDROP__GOODIES_DB_H
 
 #include <string>                   // std::string
-#include <map>                      // std::map
-#include <set>                      // std::set
 #include <mutex>                    // std::mutex
-#include <memory>                   // std::unique_ptr
+#include <memory>                   // std::shared_ptr
+#include <atomic>                   // std::atomic
 #include <vector>                   // std::vector
+#include <ctime>                    // time_t
 
 #include "shopndrop_web_protocol/protocol.h" // shopndrop_protocol::ProductItem
 
+#include "goodies_catalog.h"        // GoodiesCatalog
+
 namespace shopndrop {
 
 class GoodiesDB
@@ -43,6 +45,8 @@ public:
         std::string status_file;
     };
 
+    typedef std::shared_ptr<const GoodiesCatalog>  CatalogPtr;
+
 public:
 
     GoodiesDB();
@@ -51,31 +55,38 @@ public:
     bool init(
             const std::string & db_file );
 
-    std::vector<shopndrop_web_protocol::ProductItemWithId> get_all_product_items() const;
+    bool reload();
+    bool reload_if_changed();
 
-    const shopndrop_protocol::ProductItem * find_product_item( id_t id ) const;
-    const shopndrop_protocol::ProductItem * find_product_item__unlocked( id_t id ) const;
+    // returns the current snapshot of the catalog, doesn't block
+    CatalogPtr get_catalog() const;
 
-    bool validate( const shopndrop_protocol::ShoppingList & shopping_list, std::string * error_msg );
+    // paginated listing of the current snapshot, see GoodiesCatalog::get_product_items
+    uint32_t get_product_items( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, const std::string & category, uint32_t offset, uint32_t limit ) const;
 
-    void calculate_price_weight( const shopndrop_protocol::ShoppingList & shopping_list, double * price, double * weight );
+    // searches the current snapshot, see GoodiesCatalog::search
+    uint32_t search( std::vector<shopndrop_web_protocol::ProductItemWithId> * res, const std::string & query, uint32_t offset, uint32_t limit ) const;
 
-    void convert_to_detailed( shopndrop_web_protocol::ShoppingListWithProduct * res, double * price, double * weight, const shopndrop_protocol::ShoppingList & shopping_list );
+    uint32_t get_version() const;
 
 private:
 
-    bool load();
-
-private:
+    bool load( bool is_shrink_allowed );
 
-    typedef std::map< id_t, shopndrop_protocol::ProductItem >     MapIdToProductItem;
+    bool get_db_file_mtime( time_t * mtime ) const;
 
 private:
-    mutable std::mutex          mutex_;
+    // an automatic reload is rejected, if the catalog would shrink below this share of its current size
+    static const uint32_t       MIN_RELOAD_SIZE_PERCENT = 50;
+
+    mutable std::mutex          mutex_;     // serializes writers only
 
     std::string                 db_file_;
+    time_t                      db_file_mtime_;
+
+    std::atomic<uint32_t>       version_;   // incremented on each change of the catalog
 
-    MapIdToProductItem          map_id_to_product_item_;
+    CatalogPtr                  catalog_;   // accessed via std::atomic_load/store only
 };
 
 } // namespace shopndrop
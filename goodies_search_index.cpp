@@ -0,0 +1,261 @@
+/*
+
+Goodies Search Index.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "goodies_search_index.h"       // self
+
+#include <algorithm>                    // std::sort, std::partial_sort
+
+namespace shopndrop {
+
+GoodiesSearchIndex::GoodiesSearchIndex()
+{
+}
+
+void GoodiesSearchIndex::clear()
+{
+    postings_.clear();
+}
+
+void GoodiesSearchIndex::add( uint32_t index, const std::string & name, const std::string & unit )
+{
+    add_words( index, name, NAME );
+    add_words( index, unit, UNIT );
+}
+
+void GoodiesSearchIndex::add_words( uint32_t index, const std::string & s, field_e field )
+{
+    std::vector<std::string> words;
+
+    split_words( & words, fold_case( s ) );
+
+    for( auto & w : words )
+    {
+        postings_.push_back( { std::move( w ), index, field } );
+    }
+}
+
+void GoodiesSearchIndex::finalize()
+{
+    std::sort( postings_.begin(), postings_.end(),
+            []( const Posting & a, const Posting & b )
+            {
+                if( a.term != b.term )
+                    return a.term < b.term;
+
+                return a.index < b.index;
+            } );
+
+    postings_.shrink_to_fit();
+}
+
+std::string GoodiesSearchIndex::fold_case( const std::string & s )
+{
+    std::string res;
+
+    res.reserve( s.size() );
+
+    for( size_t i = 0; i < s.size(); ++i )
+    {
+        auto c = static_cast<unsigned char>( s[i] );
+
+        if( c >= 'A' && c <= 'Z' )
+        {
+            res.push_back( static_cast<char>( c + ( 'a' - 'A' ) ) );
+            continue;
+        }
+
+        if( i + 1 < s.size() )
+        {
+            auto c2 = static_cast<unsigned char>( s[i + 1] );
+
+            // Latin-1: U+00C0..U+00DE -> U+00E0..U+00FE, except U+00D7 (multiplication sign)
+            if( c == 0xC3 && c2 >= 0x80 && c2 <= 0x9E && c2 != 0x97 )
+            {
+                res.push_back( static_cast<char>( c ) );
+                res.push_back( static_cast<char>( c2 + 0x20 ) );
+                ++i;
+                continue;
+            }
+
+            // Cyrillic: U+0410..U+042F -> U+0430..U+044F, U+0401 -> U+0451
+            if( c == 0xD0 && c2 >= 0x90 && c2 <= 0xAF )
+            {
+                if( c2 <= 0x9F )
+                {
+                    res.push_back( static_cast<char>( 0xD0 ) );
+                    res.push_back( static_cast<char>( c2 + 0x20 ) );
+                }
+                else
+                {
+                    res.push_back( static_cast<char>( 0xD1 ) );
+                    res.push_back( static_cast<char>( c2 - 0x20 ) );
+                }
+                ++i;
+                continue;
+            }
+
+            if( c == 0xD0 && c2 == 0x81 )
+            {
+                res.push_back( static_cast<char>( 0xD1 ) );
+                res.push_back( static_cast<char>( 0x91 ) );
+                ++i;
+                continue;
+            }
+        }
+
+        res.push_back( static_cast<char>( c ) );
+    }
+
+    return res;
+}
+
+void GoodiesSearchIndex::split_words( std::vector<std::string> * res, const std::string & folded )
+{
+    size_t start = 0;
+
+    for( size_t i = 0; i <= folded.size(); ++i )
+    {
+        auto c = ( i < folded.size() ) ? static_cast<unsigned char>( folded[i] ) : ' ';
+
+        // bytes of multibyte UTF-8 sequences are treated as letters
+        bool is_word_char = ( c >= 'a' && c <= 'z' ) || ( c >= '0' && c <= '9' ) || c >= 0x80;
+
+        if( is_word_char )
+            continue;
+
+        if( i > start )
+            res->push_back( folded.substr( start, i - start ) );
+
+        start = i + 1;
+    }
+}
+
+uint32_t GoodiesSearchIndex::get_score( const Posting & p, const std::string & token )
+{
+    // whole words rank above prefixes, names rank above units
+    uint32_t res = ( p.term.size() == token.size() ) ? 2 : 1;
+
+    if( p.field == NAME )
+        res *= 2;
+
+    return res;
+}
+
+uint32_t GoodiesSearchIndex::search( std::vector<uint32_t> * res, const std::string & query, uint32_t offset, uint32_t limit ) const
+{
+    std::vector<std::string> tokens;
+
+    split_words( & tokens, fold_case( query ) );
+
+    if( tokens.empty() )
+        return 0;
+
+    // work is proportional to the number of matched postings, not to the size of the catalog
+    VectorMatch matches;
+
+    find_matches( & matches, tokens[0] );
+
+    for( uint32_t t = 1; t < tokens.size() && matches.empty() == false; ++t )
+    {
+        VectorMatch token_matches;
+
+        find_matches( & token_matches, tokens[t] );
+
+        intersect( & matches, token_matches );
+    }
+
+    auto total = static_cast<uint32_t>( matches.size() );
+
+    if( offset >= total )
+        return total;
+
+    auto end = offset + std::min( limit, total - offset );
+
+    std::partial_sort( matches.begin(), matches.begin() + end, matches.end(),
+            []( const std::pair<uint32_t,uint32_t> & a, const std::pair<uint32_t,uint32_t> & b )
+            {
+                if( a.second != b.second )
+                    return a.second > b.second;
+
+                return a.first < b.first;
+            } );
+
+    res->reserve( res->size() + end - offset );
+
+    for( auto i = offset; i < end; ++i )
+    {
+        res->push_back( matches[i].first );
+    }
+
+    return total;
+}
+
+void GoodiesSearchIndex::find_matches( VectorMatch * res, const std::string & token ) const
+{
+    auto it = std::lower_bound( postings_.begin(), postings_.end(), token,
+            []( const Posting & p, const std::string & s ) { return p.term < s; } );
+
+    for( ; it != postings_.end() && it->term.compare( 0, token.size(), token ) == 0; ++it )
+    {
+        res->emplace_back( it->index, get_score( * it, token ) );
+    }
+
+    // postings of different terms with the same prefix are not ordered by index
+    std::sort( res->begin(), res->end() );
+
+    // one item can match the token with several words, sum up their scores
+    size_t n = 0;
+
+    for( size_t i = 0; i < res->size(); ++i )
+    {
+        auto m = ( * res )[i];
+
+        if( n > 0 && ( * res )[n - 1].first == m.first )
+            ( * res )[n - 1].second += m.second;
+        else
+            ( * res )[n++] = m;
+    }
+
+    res->resize( n );
+}
+
+void GoodiesSearchIndex::intersect( VectorMatch * matches, const VectorMatch & token_matches )
+{
+    // both are sorted by index, keep items present in both and add up their scores
+    size_t n = 0;
+
+    auto it = token_matches.begin();
+
+    for( size_t i = 0; i < matches->size() && it != token_matches.end(); ++i )
+    {
+        auto m = ( * matches )[i];
+
+        while( it != token_matches.end() && it->first < m.first )
+            ++it;
+
+        if( it != token_matches.end() && it->first == m.first )
+            ( * matches )[n++] = { m.first, m.second + it->second };
+    }
+
+    matches->resize( n );
+}
+
+} // namespace shopndrop
@@ -0,0 +1,92 @@
+/*
+
+Goodies Search Index.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHOPNDROP__GOODIES_SEARCH_INDEX_H
+#define SHOPNDROP__GOODIES_SEARCH_INDEX_H
+
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+#include <cstdint>                  // uint32_t
+
+namespace shopndrop {
+
+/**
+ * @brief Inverted index over words of product name and unit.
+ *
+ * Words are case folded (ASCII, Latin-1 and Cyrillic letters in UTF-8), every word of the query
+ * must match the beginning of some word of the product, i.e. "bär kä" finds "Bärenmarke Käse".
+ *
+ * Results are referred to by their position in the catalog.
+ */
+class GoodiesSearchIndex
+{
+public:
+
+    GoodiesSearchIndex();
+
+    void clear();
+
+    void add( uint32_t index, const std::string & name, const std::string & unit );
+
+    // must be called after all items were added
+    void finalize();
+
+    // returns the total number of matches, fills res with the matches [offset, offset + limit) sorted by relevance
+    uint32_t search( std::vector<uint32_t> * res, const std::string & query, uint32_t offset, uint32_t limit ) const;
+
+    static std::string fold_case( const std::string & s );
+
+private:
+
+    enum field_e
+    {
+        NAME    = 0,
+        UNIT    = 1,
+    };
+
+    struct Posting
+    {
+        std::string term;
+        uint32_t    index;
+        field_e     field;
+    };
+
+    // item index and accumulated score, sorted by index
+    typedef std::vector<std::pair<uint32_t,uint32_t>>   VectorMatch;
+
+    void add_words( uint32_t index, const std::string & s, field_e field );
+
+    void find_matches( VectorMatch * res, const std::string & token ) const;
+
+    static void intersect( VectorMatch * matches, const VectorMatch & token_matches );
+
+    static void split_words( std::vector<std::string> * res, const std::string & folded );
+
+    static uint32_t get_score( const Posting & p, const std::string & token );
+
+private:
+
+    std::vector<Posting>    postings_;      // sorted by term
+};
+
+} // namespace shopndrop
+
+#endif // SHOPNDROP__GOODIES_SEARCH_INDEX_H
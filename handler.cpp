@@ -121,17 +121,67 @@ bool Handler::validate( std::string * error_msg, uint32_t * delivery_time, user_
         return false;
     }
 
+    if( ride->get_ride().is_open == false )
+    {
+        * error_msg = "ride id " + std::to_string( r.ride_id ) + " is closed";
+        return false;
+    }
+
     * delivery_time     = ride->get_delivery_time();
     * shopper_id        = ride->get_attrib().user_id;
 
-    if( goodies_db_->validate( r.shopping_list, error_msg ) == false )
+    return true;
+}
+
+void Handler::find_ride_infos( std::vector<RideInfo> * res, const std::vector<shopndrop_protocol::AddOrderRequest> & requests ) const
+{
+    res->reserve( requests.size() );
+
+    auto & mutex = order_db_->get_mutex();
+
+    MUTEX_SCOPE_LOCK( mutex );
+
+    for( auto & r : requests )
     {
-        return false;
+        res->push_back( RideInfo() );
+
+        auto & e = res->back();
+
+        auto ride = order_db_->find_ride__unlocked( r.ride_id );
+
+        e.is_found  = ( ride != nullptr );
+
+        if( ride == nullptr )
+            continue;
+
+        e.is_open       = ride->get_ride().is_open;
+        e.delivery_time = ride->get_delivery_time();
+        e.shopper_id    = ride->get_attrib().user_id;
     }
+}
+
+bool Handler::get_user_name( std::string * name, user_id_t user_id ) const
+{
+    auto user = user_man_->find__unlocked( user_id );
+
+    if( user.is_empty() )
+        return false;
+
+    * name = user.get_field( user_manager::User::FIRST_NAME ).arg_s + " " + user.get_field( user_manager::User::LAST_NAME ).arg_s;
 
     return true;
 }
 
+void Handler::merge_batch_results( VectorBatchResult * res, const VectorBatchResult & db_res, const std::vector<uint32_t> & db_indices )
+{
+    assert( db_res.size() == db_indices.size() );
+
+    for( uint32_t i = 0; i < db_indices.size(); ++i )
+    {
+        ( * res )[ db_indices[i] ] = db_res[i];
+    }
+}
+
 bool Handler::get_user_timezone( std::string * timezone, user_id_t user_id )
 {
     auto user = user_man_->find__unlocked( user_id );
@@ -214,7 +264,7 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
     }
 }
 
-generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_protocol::GetRideRequest & r )
+generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_protocol::GetRideRequest & r, const RequestContext & ctx )
 {
     std::string     timezone;
 
@@ -223,11 +273,8 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
         return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, "cannot obtain user's timezone" );
     }
 
-    auto & mutex = order_db_->get_mutex();
-
-    MUTEX_SCOPE_LOCK( mutex );
-
-    auto ride = order_db_->find_ride__unlocked( r.ride_id );
+    // resolved by PermChecker
+    auto & ride = ctx.ride;
 
     if( ride == nullptr )
     {
@@ -293,6 +340,15 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
         return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, error_msg );
     }
 
+    // freeze product data and prices, so that later catalog changes don't affect the order
+    shopndrop_web_protocol::ShoppingListWithTotals slwt;
+
+    // single pass over the catalog snapshot, doesn't need the OrderDB lock
+    if( goodies_db_->get_catalog()->convert_to_detailed( & slwt.shopping_list, & slwt.price, & slwt.weight, r.shopping_list, & error_msg ) == false )
+    {
+        return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, error_msg );
+    }
+
     auto shopper = user_man_->find__unlocked( shopper_id );
 
     if( shopper.is_empty() )
@@ -304,10 +360,7 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
 
     try
     {
-        double sum;
-        double weight;
-
-        goodies_db_->calculate_price_weight( r.shopping_list, & sum, & weight );
+        auto sum = slwt.price;
 
         if( is_minimal_basket_size_reached( sum ) == false )
         {
@@ -318,7 +371,7 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
 
         id_t order_id = 0;
 
-        auto b = order_db_->create_and_add_order( & order_id, r.ride_id, r.shopping_list, r.delivery_address, sum, weight, earning, delivery_time, shopper_name, session_user_id, & error_msg );
+        auto b = order_db_->create_and_add_order( & order_id, r.ride_id, slwt, r.delivery_address, sum, slwt.weight, earning, delivery_time, shopper_name, session_user_id, & error_msg );
 
         if( b == false )
         {
@@ -333,6 +386,142 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
     }
 }
 
+void Handler::handle_batch( VectorBatchResult * res, user_id_t session_user_id, const std::vector<shopndrop_protocol::AddRideRequest> & requests )
+{
+    res->assign( requests.size(), { 0, std::string() } );
+
+    std::string     timezone;
+    std::string     shopper_name;
+
+    std::string     error_msg;
+
+    if( get_user_timezone( & timezone, session_user_id ) == false )
+        error_msg = "cannot obtain user's timezone";
+    else if( get_user_name( & shopper_name, session_user_id ) == false )
+        error_msg = "user id " + std::to_string( session_user_id ) + " not found";
+
+    if( error_msg.empty() == false )
+    {
+        for( auto & e : * res )
+            e.error_msg = error_msg;
+
+        return;
+    }
+
+    std::vector<db::OrderDB::NewRide>   rides;
+    std::vector<uint32_t>               db_indices;
+
+    rides.reserve( requests.size() );
+    db_indices.reserve( requests.size() );
+
+    for( uint32_t i = 0; i < requests.size(); ++i )
+    {
+        auto & r = requests[i];
+
+        if( validate( & ( * res )[i].error_msg, r.ride, timezone ) == false )
+            continue;
+
+        rides.push_back( { r.ride, time_adj_->to_utc( r.ride.delivery_time, timezone ) } );
+        db_indices.push_back( i );
+    }
+
+    VectorBatchResult db_res;
+
+    order_db_->create_and_add_rides( & db_res, rides, shopper_name, session_user_id );
+
+    merge_batch_results( res, db_res, db_indices );
+}
+
+void Handler::handle_batch( VectorBatchResult * res, user_id_t session_user_id, const std::vector<shopndrop_protocol::AddOrderRequest> & requests )
+{
+    res->assign( requests.size(), { 0, std::string() } );
+
+    std::vector<RideInfo> ride_infos;
+
+    // all rides are looked up in one critical section
+    find_ride_infos( & ride_infos, requests );
+
+    // all items are priced against the same snapshot
+    auto catalog = goodies_db_->get_catalog();
+
+    std::map<user_id_t, std::string>    shopper_names;
+
+    std::vector<db::OrderDB::NewOrder>  orders;
+    std::vector<uint32_t>               db_indices;
+
+    orders.reserve( requests.size() );
+    db_indices.reserve( requests.size() );
+
+    for( uint32_t i = 0; i < requests.size(); ++i )
+    {
+        auto & r            = requests[i];
+        auto & ri           = ride_infos[i];
+        auto & error_msg    = ( * res )[i].error_msg;
+
+        if( ri.is_found == false )
+        {
+            error_msg = "ride id " + std::to_string( r.ride_id ) + " not found";
+            continue;
+        }
+
+        if( ri.is_open == false )
+        {
+            error_msg = "ride id " + std::to_string( r.ride_id ) + " is closed";
+            continue;
+        }
+
+        // freeze product data and prices, so that later catalog changes don't affect the order
+        shopndrop_web_protocol::ShoppingListWithTotals slwt;
+
+        if( catalog->convert_to_detailed( & slwt.shopping_list, & slwt.price, & slwt.weight, r.shopping_list, & error_msg ) == false )
+            continue;
+
+        auto sum = slwt.price;
+
+        if( is_minimal_basket_size_reached( sum ) == false )
+        {
+            error_msg = "basket size is smaller than minimal size (" + std::to_string( sum ) + " < " + std::to_string( get_minimal_basket_size() ) + ")";
+            continue;
+        }
+
+        auto it = shopper_names.find( ri.shopper_id );
+
+        if( it == shopper_names.end() )
+        {
+            std::string name;
+
+            if( get_user_name( & name, ri.shopper_id ) == false )
+            {
+                error_msg = "shopper with id " + std::to_string( ri.shopper_id ) + " not found";
+                continue;
+            }
+
+            it = shopper_names.insert( std::make_pair( ri.shopper_id, name ) ).first;
+        }
+
+        orders.push_back( db::OrderDB::NewOrder() );
+
+        auto & o = orders.back();
+
+        o.ride_id           = r.ride_id;
+        o.delivery_address  = r.delivery_address;
+        o.shopping_list     = std::move( slwt );
+        o.sum               = sum;
+        o.weight            = o.shopping_list.weight;
+        o.earning           = calculate_earning( sum );
+        o.delivery_time     = ri.delivery_time;
+        o.shopper_name      = it->second;
+
+        db_indices.push_back( i );
+    }
+
+    VectorBatchResult db_res;
+
+    order_db_->create_and_add_orders( & db_res, orders, session_user_id );
+
+    merge_batch_results( res, db_res, db_indices );
+}
+
 generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_protocol::CancelOrderRequest & r )
 {
     return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, "not implemented yet" );
@@ -396,47 +585,38 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
 
 generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_web_protocol::GetProductItemListRequest & r )
 {
-    auto pids = goodies_db_->get_all_product_items();
-
-    auto res = shopndrop_web_protocol::create_GetProductItemListResponse( pids );
+    // the snapshot keeps the items alive while the response copies them
+    auto catalog = goodies_db_->get_catalog();
 
-    return res;
+    return shopndrop_web_protocol::create_GetProductItemListResponse( catalog->get_all_product_items() );
 }
 
-generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_web_protocol::GetShoppingRequestInfoRequest & r )
+generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_web_protocol::GetShoppingRequestInfoRequest & r, const RequestContext & ctx )
 {
-    std::vector<shopndrop_web_protocol::ShoppingRequestInfo> requests;
-
-    std::string error_msg;
-
-    auto b = order_db_->get_shopping_info_requests( & requests, r.ride_id, session_user_id, & error_msg );
-
-    if( b == false )
+    // resolved by PermChecker
+    if( ctx.ride == nullptr )
     {
-        return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, error_msg );
+        return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, "ride " + std::to_string( r.ride_id ) + " doesn't exist" );
     }
 
+    std::vector<shopndrop_web_protocol::ShoppingRequestInfo> requests;
+
+    order_db_->get_shopping_info_requests( & requests, ctx.ride, session_user_id );
+
     return shopndrop_web_protocol::create_GetShoppingRequestInfoResponse( requests );
 }
 
-generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_web_protocol::GetShoppingListWithTotalsRequest & r )
+generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_web_protocol::GetShoppingListWithTotalsRequest & r, const RequestContext & ctx )
 {
-    auto & mutex = order_db_->get_mutex();
-
-    MUTEX_SCOPE_LOCK( mutex );
-
-    auto shopping_list = order_db_->find_shopping_list__unlocked( r.shopping_list_id );
+    // resolved by PermChecker
+    auto & shopping_list = ctx.shopping_list;
 
     if( shopping_list == nullptr )
     {
         return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, "shopping list not found" );
     }
 
-    shopndrop_web_protocol::ShoppingListWithTotals slwt;
-
-    goodies_db_->convert_to_detailed( & slwt.shopping_list, & slwt.price, & slwt.weight, shopping_list->get_shopping_list() );
-
-    return shopndrop_web_protocol::create_GetShoppingListWithTotalsResponse( slwt );
+    return shopndrop_web_protocol::create_GetShoppingListWithTotalsResponse( shopping_list->get_shopping_list() );
 }
 
 generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, const shopndrop_web_protocol::GetDashScreenUserRequest & r )
@@ -448,15 +628,11 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
         return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, "cannot obtain user's timezone" );
     }
 
-    auto & mutex = order_db_->get_mutex();
-
-    MUTEX_SCOPE_LOCK( mutex );
-
     db::OrderDB::VectorRide rides;
     db::OrderDB::VectorOrder orders;
     std::string error_msg;
 
-    order_db_->get_info_for_user__unlocked( & rides, & orders, r.position, session_user_id, & error_msg );
+    order_db_->get_info_for_user( & rides, & orders, r.position, session_user_id, & error_msg );
 
     shopndrop_web_protocol::DashScreenUser dash_screen;
 
@@ -474,15 +650,11 @@ generic_protocol::BackwardMessage* Handler::handle( user_id_t session_user_id, c
         return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, "cannot obtain user's timezone" );
     }
 
-    auto & mutex = order_db_->get_mutex();
-
-    MUTEX_SCOPE_LOCK( mutex );
-
     db::OrderDB::VectorRide rides;
     db::OrderDB::VectorOrder orders;
     std::string error_msg;
 
-    order_db_->get_info_for_shopper__unlocked( & rides, & orders, session_user_id, & error_msg );
+    order_db_->get_info_for_shopper( & rides, & orders, session_user_id, & error_msg );
 
     shopndrop_web_protocol::DashScreenShopper dash_screen;
 
@@ -36,6 +36,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "time_adjuster.h"          // TimeAdjuster
 #include "db_obj_generator.h"       // ObjGenerator
 #include "goodies_db.h"             // GoodiesDB
+#include "request_context.h"        // RequestContext
 
 #include "types.h"                  // job_id_t
 
@@ -65,7 +66,7 @@ public:
             GoodiesDB                           * goodies_db );
 
     generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_protocol::AddRideRequest & r );
-    generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_protocol::GetRideRequest & r );
+    generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_protocol::GetRideRequest & r, const RequestContext & ctx );
     generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_protocol::CancelRideRequest & r );
     generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const user_management_protocol::GetUserInfoRequest & r );
     generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_protocol::AddOrderRequest & r );
@@ -76,16 +77,36 @@ public:
     generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_protocol::RateShopperRequest & r );
 
     generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_web_protocol::GetProductItemListRequest & r );
-    generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_web_protocol::GetShoppingRequestInfoRequest & r );
-    generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_web_protocol::GetShoppingListWithTotalsRequest & r );
+    generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_web_protocol::GetShoppingRequestInfoRequest & r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_web_protocol::GetShoppingListWithTotalsRequest & r, const RequestContext & ctx );
     generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_web_protocol::GetDashScreenUserRequest & r );
     generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const shopndrop_web_protocol::GetDashScreenShopperRequest & r );
 
+    typedef std::vector<db::OrderDB::BatchResult>   VectorBatchResult;
+
+    // batch variants: validated in one pass, added in one OrderDB critical section, one result per request
+    void handle_batch( VectorBatchResult * res, user_id_t session_user_id, const std::vector<shopndrop_protocol::AddRideRequest> & requests );
+    void handle_batch( VectorBatchResult * res, user_id_t session_user_id, const std::vector<shopndrop_protocol::AddOrderRequest> & requests );
+
 private:
 
+    struct RideInfo
+    {
+        uint32_t    delivery_time;
+        user_id_t   shopper_id;
+        bool        is_found;
+        bool        is_open;
+    };
+
     bool validate( std::string * error_msg, const shopndrop_protocol::RideSummary & r, const std::string & timezone ) const;
     bool validate( std::string * error_msg, uint32_t * delivery_time, user_id_t * shopper_id, const shopndrop_protocol::AddOrderRequest & r ) const;
 
+    void find_ride_infos( std::vector<RideInfo> * res, const std::vector<shopndrop_protocol::AddOrderRequest> & requests ) const;
+
+    bool get_user_name( std::string * name, user_id_t user_id ) const;
+
+    static void merge_batch_results( VectorBatchResult * res, const VectorBatchResult & db_res, const std::vector<uint32_t> & db_indices );
+
     typedef std::map<std::string, std::string>  MapKeyValue;
 
     double get_minimal_basket_size() const;
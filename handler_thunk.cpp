@@ -75,7 +75,7 @@ bool HandlerThunk::is_inited__() const
     return true;
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle( user_id_t session_user_id, const basic_parser::Object * req )
+generic_protocol::BackwardMessage* HandlerThunk::handle( user_id_t session_user_id, const basic_parser::Object * req, const RequestContext & ctx )
 {
     MUTEX_SCOPE_LOCK( mutex_ );
 
@@ -83,7 +83,7 @@ generic_protocol::BackwardMessage* HandlerThunk::handle( user_id_t session_user_
 
     typedef HandlerThunk Type;
 
-    typedef generic_protocol::BackwardMessage* (Type::*PPMF)( user_id_t session_user_id, const basic_parser::Object * r );
+    typedef generic_protocol::BackwardMessage* (Type::*PPMF)( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
 
 #define MAP_ENTRY(_v)       { typeid( shopndrop_protocol::_v ),        & Type::handle_##_v }
 #define MAP_ENTRY_WEB(_v)   { typeid( shopndrop_web_protocol::_v ),   & Type::handle_web_##_v }
@@ -120,82 +120,96 @@ generic_protocol::BackwardMessage* HandlerThunk::handle( user_id_t session_user_
         return generic_handler_->handle( session_user_id, req );
     }
 
-    return (this->*it->second)( session_user_id, req );
+    return (this->*it->second)( session_user_id, req, ctx );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_AddRideRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+void HandlerThunk::handle_batch( std::vector<db::OrderDB::BatchResult> * res, user_id_t session_user_id, const std::vector<shopndrop_protocol::AddRideRequest> & requests )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    handler_->handle_batch( res, session_user_id, requests );
+}
+
+void HandlerThunk::handle_batch( std::vector<db::OrderDB::BatchResult> * res, user_id_t session_user_id, const std::vector<shopndrop_protocol::AddOrderRequest> & requests )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    handler_->handle_batch( res, session_user_id, requests );
+}
+
+generic_protocol::BackwardMessage* HandlerThunk::handle_AddRideRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     // private: no mutex lock
 
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::AddRideRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_GetRideRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_GetRideRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
-    return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::GetRideRequest &>( * rr ) );
+    return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::GetRideRequest &>( * rr ), ctx );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_CancelRideRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_CancelRideRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::CancelRideRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_user_management_GetUserInfoRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_user_management_GetUserInfoRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const user_management_protocol::GetUserInfoRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_AddOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_AddOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::AddOrderRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_CancelOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_CancelOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::CancelOrderRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_AcceptOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_AcceptOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::AcceptOrderRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_DeclineOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_DeclineOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::DeclineOrderRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_MarkDeliveredOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_MarkDeliveredOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::MarkDeliveredOrderRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_RateShopperRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_RateShopperRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_protocol::RateShopperRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetProductItemListRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetProductItemListRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_web_protocol::GetProductItemListRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetShoppingRequestInfoRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetShoppingRequestInfoRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
-    return handler_->handle( session_user_id, dynamic_cast< const shopndrop_web_protocol::GetShoppingRequestInfoRequest &>( * rr ) );
+    return handler_->handle( session_user_id, dynamic_cast< const shopndrop_web_protocol::GetShoppingRequestInfoRequest &>( * rr ), ctx );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetShoppingListWithTotalsRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetShoppingListWithTotalsRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
-    return handler_->handle( session_user_id, dynamic_cast< const shopndrop_web_protocol::GetShoppingListWithTotalsRequest &>( * rr ) );
+    return handler_->handle( session_user_id, dynamic_cast< const shopndrop_web_protocol::GetShoppingListWithTotalsRequest &>( * rr ), ctx );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetDashScreenUserRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetDashScreenUserRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_web_protocol::GetDashScreenUserRequest &>( * rr ) );
 }
 
-generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetDashScreenShopperRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+generic_protocol::BackwardMessage* HandlerThunk::handle_web_GetDashScreenShopperRequest( user_id_t session_user_id, const basic_parser::Object * rr, const RequestContext & ctx )
 {
     return handler_->handle( session_user_id, dynamic_cast< const shopndrop_web_protocol::GetDashScreenShopperRequest &>( * rr ) );
 }
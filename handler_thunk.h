@@ -25,10 +25,14 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #define SHOPNDROP__HANDLER_THUNK_H
 
 #include <mutex>                    // std::mutex
+#include <vector>                   // std::vector
 
 #include "generic_protocol/protocol.h"  // generic_protocol::BackwardMessage
+#include "shopndrop_protocol/protocol.h"    // shopndrop_protocol::AddRideRequest
 
 #include "types.h"                  // user_id_t
+#include "request_context.h"        // RequestContext
+#include "db_order_db.h"            // db::OrderDB::BatchResult
 
 namespace generic_handler
 {
@@ -51,26 +55,29 @@ public:
             Handler                             * handler );
 
     // quasi-interface IHandler
-    generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const basic_parser::Object * r );
+    generic_protocol::BackwardMessage* handle( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+
+    void handle_batch( std::vector<db::OrderDB::BatchResult> * res, user_id_t session_user_id, const std::vector<shopndrop_protocol::AddRideRequest> & requests );
+    void handle_batch( std::vector<db::OrderDB::BatchResult> * res, user_id_t session_user_id, const std::vector<shopndrop_protocol::AddOrderRequest> & requests );
 
 private:
 
-    generic_protocol::BackwardMessage* handle_AddRideRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_GetRideRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_CancelRideRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_user_management_GetUserInfoRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_AddOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_CancelOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_AcceptOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_DeclineOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_MarkDeliveredOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_RateShopperRequest( user_id_t session_user_id, const basic_parser::Object * r );
-
-    generic_protocol::BackwardMessage* handle_web_GetProductItemListRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_web_GetShoppingRequestInfoRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_web_GetShoppingListWithTotalsRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_web_GetDashScreenUserRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    generic_protocol::BackwardMessage* handle_web_GetDashScreenShopperRequest( user_id_t session_user_id, const basic_parser::Object * r );
+    generic_protocol::BackwardMessage* handle_AddRideRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_GetRideRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_CancelRideRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_user_management_GetUserInfoRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_AddOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_CancelOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_AcceptOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_DeclineOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_MarkDeliveredOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_RateShopperRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+
+    generic_protocol::BackwardMessage* handle_web_GetProductItemListRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_web_GetShoppingRequestInfoRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_web_GetShoppingListWithTotalsRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_web_GetDashScreenUserRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
+    generic_protocol::BackwardMessage* handle_web_GetDashScreenShopperRequest( user_id_t session_user_id, const basic_parser::Object * r, const RequestContext & ctx );
 
     bool is_inited__() const;
 
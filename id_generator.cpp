@@ -0,0 +1,219 @@
+/*
+
+Id Generator.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "id_generator.h"               // self
+
+#include <fstream>                      // std::ifstream
+#include <cstdio>                       // std::rename
+#include <cstdlib>                      // strtoul
+#include <cstring>                      // strerror
+#include <cerrno>                       // errno
+#include <fcntl.h>                      // open
+#include <unistd.h>                     // write, fsync, close
+
+#include "utils/mutex_helper.h"      // MUTEX_SCOPE_LOCK
+#include "utils/dummy_logger.h"      // dummy_log
+
+#define MODULENAME      "IdGenerator"
+
+namespace shopndrop {
+
+IdGenerator::IdGenerator():
+    block_size_( 0 ),
+    last_id_( 0 ),
+    limit_( 0 )
+{
+}
+
+bool IdGenerator::init( const std::string & filename, uint32_t block_size, std::string * error_msg )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    filename_   = filename;
+    block_size_ = ( block_size > 0 ) ? block_size : 1;
+
+    id_t limit      = 0;
+    bool is_found   = false;
+
+    if( load( & limit, & is_found, error_msg ) == false )
+        return false;
+
+    // first start: create the file now, so that a wrong path is noticed at startup
+    if( is_found == false && save( limit, error_msg ) == false )
+        return false;
+
+    // ids up to the persisted limit might have been handed out before the restart
+    last_id_    = limit;
+    limit_      = limit;
+
+    dummy_log_info( MODULENAME, "init: last id %u, block size %u", limit, block_size_ );
+
+    return true;
+}
+
+bool IdGenerator::get_next_id( id_t * id, std::string * error_msg )
+{
+    auto res = ++last_id_;
+
+    if( res > limit_.load( std::memory_order_acquire ) )
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        // the id is lost on failure, which leaves a gap but never a duplicate
+        if( reserve_block__unlocked( res, error_msg ) == false )
+            return false;
+    }
+
+    * id = res;
+
+    return true;
+}
+
+bool IdGenerator::reserve_block__unlocked( id_t id, std::string * error_msg )
+{
+    auto limit = limit_.load( std::memory_order_relaxed );
+
+    // another thread could have reserved a block covering this id already
+    if( id <= limit )
+        return true;
+
+    // several threads may have overrun the limit concurrently, cover them all
+    while( limit < id )
+        limit += block_size_;
+
+    // persist before handing out, otherwise ids could repeat after a crash
+    if( save( limit, error_msg ) == false )
+    {
+        dummy_log_error( MODULENAME, "cannot persist id limit %u: %s", limit, error_msg->c_str() );
+
+        * error_msg = "cannot allocate id: " + * error_msg;
+
+        return false;
+    }
+
+    limit_.store( limit, std::memory_order_release );
+
+    return true;
+}
+
+bool IdGenerator::load( id_t * limit, bool * is_found, std::string * error_msg ) const
+{
+    errno = 0;
+
+    std::ifstream is( filename_ );
+
+    if( is.is_open() == false )
+    {
+        // only a missing file means first start, anything else must not restart the ids from 0
+        if( errno != ENOENT )
+        {
+            * error_msg = "cannot open " + filename_ + ": " + strerror( errno );
+            return false;
+        }
+
+        dummy_log_warn( MODULENAME, "%s doesn't exist, starting from 0", filename_.c_str() );
+
+        * limit     = 0;
+        * is_found  = false;
+
+        return true;
+    }
+
+    * is_found  = true;
+
+    std::string line;
+
+    std::getline( is, line );
+
+    char * end = nullptr;
+
+    auto v = strtoul( line.c_str(), & end, 10 );
+
+    if( line.empty() || * end != '\0' || v > 0xFFFFFFFF )
+    {
+        * error_msg = filename_ + ": invalid id limit '" + line + "'";
+        return false;
+    }
+
+    * limit = static_cast<id_t>( v );
+
+    return true;
+}
+
+bool IdGenerator::save( id_t limit, std::string * error_msg ) const
+{
+    auto temp_name  = filename_ + ".tmp";
+
+    auto fd = open( temp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+
+    if( fd < 0 )
+    {
+        * error_msg = "cannot open " + temp_name + ": " + strerror( errno );
+        return false;
+    }
+
+    auto s = std::to_string( limit ) + "\n";
+
+    bool b = ( write( fd, s.data(), s.size() ) == static_cast<ssize_t>( s.size() ) ) && ( fsync( fd ) == 0 );
+
+    if( b == false )
+        * error_msg = "cannot write " + temp_name + ": " + strerror( errno );
+
+    close( fd );
+
+    if( b == false )
+        return false;
+
+    if( std::rename( temp_name.c_str(), filename_.c_str() ) != 0 )
+    {
+        * error_msg = "cannot rename " + temp_name + ": " + strerror( errno );
+        return false;
+    }
+
+    // the rename itself is only durable once the directory entry is on disk
+    return sync_dir( error_msg );
+}
+
+bool IdGenerator::sync_dir( std::string * error_msg ) const
+{
+    auto pos = filename_.rfind( '/' );
+
+    std::string dir = ( pos == std::string::npos ) ? "." : ( pos == 0 ) ? "/" : filename_.substr( 0, pos );
+
+    auto fd = open( dir.c_str(), O_RDONLY | O_DIRECTORY );
+
+    if( fd < 0 )
+    {
+        * error_msg = "cannot open directory " + dir + ": " + strerror( errno );
+        return false;
+    }
+
+    bool b = ( fsync( fd ) == 0 );
+
+    if( b == false )
+        * error_msg = "cannot sync directory " + dir + ": " + strerror( errno );
+
+    close( fd );
+
+    return b;
+}
+
+} // namespace shopndrop
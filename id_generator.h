@@ -0,0 +1,73 @@
+/*
+
+Id Generator.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHOPNDROP__ID_GENERATOR_H
+#define SHOPNDROP__ID_GENERATOR_H
+
+#include <string>                   // std::string
+#include <mutex>                    // std::mutex
+#include <atomic>                   // std::atomic
+
+#include "types.h"                  // id_t
+
+namespace shopndrop {
+
+/**
+ * @brief Monotonic id generator, which doesn't repeat ids after a restart or a crash.
+ *
+ * Ids are handed out by an atomic increment. Only the upper bound of the current block
+ * of ids is persisted, once per block, before any id of the block is handed out.
+ * After a restart the generator continues above the persisted bound, i.e. at most one
+ * block of ids is skipped. If the bound cannot be persisted, no id of the new block is handed out.
+ */
+class IdGenerator
+{
+public:
+
+    IdGenerator();
+
+    bool init( const std::string & filename, uint32_t block_size, std::string * error_msg );
+
+    // thread-safe, doesn't block unless a new block has to be reserved
+    bool get_next_id( id_t * id, std::string * error_msg );
+
+private:
+
+    bool reserve_block__unlocked( id_t id, std::string * error_msg );
+
+    bool load( id_t * limit, bool * is_found, std::string * error_msg ) const;
+    bool save( id_t limit, std::string * error_msg ) const;
+    bool sync_dir( std::string * error_msg ) const;
+
+private:
+
+    mutable std::mutex      mutex_;     // serializes reservation of blocks
+
+    std::string             filename_;
+    uint32_t                block_size_;
+
+    std::atomic<id_t>       last_id_;
+    std::atomic<id_t>       limit_;     // last id of the reserved block
+};
+
+} // namespace shopndrop
+
+#endif // SHOPNDROP__ID_GENERATOR_H
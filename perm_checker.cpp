@@ -26,6 +26,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <typeindex>                    // std::type_index
 #include <unordered_map>
 
+#include "generic_protocol/protocol.h"         // generic_protocol::Request
 #include "user_reg_protocol/protocol.h"        // user_reg_protocol::
 #include "user_management_protocol/protocol.h"  // user_management_protocol::
 #include "shopndrop_protocol/protocol.h"      // shopndrop_protocol::
@@ -38,6 +39,9 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 namespace shopndrop {
 
+// sessions closed or expired in session_manager are noticed after at most this time
+const uint32_t SESSION_CACHE_TTL_SEC    = 5;
+
 PermChecker::PermChecker():
     generic_perm_checker_( nullptr ),
     sess_man_( nullptr ),
@@ -57,19 +61,47 @@ bool PermChecker::init(
     sess_man_               = sess_man;
     order_db_                = order_db;
 
+    session_cache_.init( SESSION_CACHE_TTL_SEC );
+
     return true;
 }
 
 bool PermChecker::is_authenticated( user_id_t * session_user_id, const basic_parser::Object * rr )
 {
-    return generic_perm_checker_->is_authenticated( session_user_id, rr );
+    auto req = dynamic_cast< const generic_protocol::Request *>( rr );
+
+    if( req == nullptr )
+        return generic_perm_checker_->is_authenticated( session_user_id, rr );
+
+    if( session_cache_.find( session_user_id, req->session_id ) )
+        return true;
+
+    if( generic_perm_checker_->is_authenticated( session_user_id, rr ) == false )
+        return false;
+
+    session_cache_.add( req->session_id, * session_user_id );
+
+    return true;
+}
+
+void PermChecker::invalidate_session( const std::string & session_id )
+{
+    session_cache_.remove( session_id );
 }
 
-bool PermChecker::is_allowed( user_id_t session_user_id, const basic_parser::Object * req )
+void PermChecker::purge_session_cache()
+{
+    auto n = session_cache_.purge();
+
+    if( n > 0 )
+        dummy_log_debug( MODULENAME, "purge_session_cache: removed %u expired session(s)", n );
+}
+
+bool PermChecker::is_allowed( user_id_t session_user_id, const basic_parser::Object * req, RequestContext * ctx )
 {
     typedef PermChecker Type;
 
-    typedef bool (Type::*PPMF)( user_id_t session_user_id, const basic_parser::Object * rr );
+    typedef bool (Type::*PPMF)( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx );
 
 #define MAP_ENTRY(_v)       { typeid( shopndrop_protocol::_v ),         & Type::is_allowed_##_v }
 #define MAP_ENTRY_WEB(_v)   { typeid( shopndrop_web_protocol::_v ),    & Type::is_allowed_web_##_v }
@@ -110,115 +142,115 @@ bool PermChecker::is_allowed( user_id_t session_user_id, const basic_parser::Obj
         return generic_perm_checker_->is_allowed( session_user_id, req );
     }
 
-    return (this->*it->second)( session_user_id, req );
+    return (this->*it->second)( session_user_id, req, ctx );
 }
 
-bool PermChecker::is_allowed_AddRideRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_AddRideRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     //auto & r = dynamic_cast< const shopndrop_protocol::AddRideRequest &>( * rr );
 
     return true;
 }
 
-bool PermChecker::is_allowed_GetRideRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_GetRideRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_protocol::GetRideRequest &>( * rr );
 
-    return is_ride_id_valid( session_user_id, r.ride_id, true );
+    return is_ride_id_valid( session_user_id, r.ride_id, true, ctx );
 }
 
-bool PermChecker::is_allowed_CancelRideRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_CancelRideRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_protocol::CancelRideRequest &>( * rr );
 
-    return is_ride_id_valid( session_user_id, r.ride_id, true );
+    return is_ride_id_valid( session_user_id, r.ride_id, true, nullptr );
 }
 
-bool PermChecker::is_allowed_AddOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_AddOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     //auto & r = dynamic_cast< const shopndrop_protocol::AddOrderRequest &>( * rr );
 
     return true;
 }
 
-bool PermChecker::is_allowed_CancelOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_CancelOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_protocol::CancelOrderRequest &>( * rr );
 
-    return is_order_id_valid( session_user_id, r.order_id, true );
+    return is_order_id_valid( session_user_id, r.order_id, true, nullptr );
 }
 
-bool PermChecker::is_allowed_AcceptOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_AcceptOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_protocol::AcceptOrderRequest &>( * rr );
 
-    return is_order_id_valid( session_user_id, r.order_id, false );
+    return is_order_id_valid( session_user_id, r.order_id, false, nullptr );
 }
 
-bool PermChecker::is_allowed_DeclineOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_DeclineOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_protocol::DeclineOrderRequest &>( * rr );
 
-    return is_order_id_valid( session_user_id, r.order_id, false );
+    return is_order_id_valid( session_user_id, r.order_id, false, nullptr );
 }
 
-bool PermChecker::is_allowed_MarkDeliveredOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_MarkDeliveredOrderRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_protocol::MarkDeliveredOrderRequest &>( * rr );
 
-    return is_order_id_valid( session_user_id, r.order_id, false );
+    return is_order_id_valid( session_user_id, r.order_id, false, nullptr );
 }
 
-bool PermChecker::is_allowed_RateShopperRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_RateShopperRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_protocol::RateShopperRequest &>( * rr );
 
-    return is_order_id_valid( session_user_id, r.order_id, true );
+    return is_order_id_valid( session_user_id, r.order_id, true, nullptr );
 }
 
-bool PermChecker::is_allowed_user_management_GetUserInfoRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_user_management_GetUserInfoRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const user_management_protocol::GetUserInfoRequest &>( * rr );
 
     return validate_user_id( session_user_id, r.user_id );
 }
 
-bool PermChecker::is_allowed_web_GetProductItemListRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_web_GetProductItemListRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     //auto & r = dynamic_cast< const shopndrop_web_protocol::GetProductItemListRequest &>( * rr );
 
     return true;
 }
 
-bool PermChecker::is_allowed_web_GetShoppingListWithTotalsRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_web_GetShoppingListWithTotalsRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_web_protocol::GetShoppingListWithTotalsRequest &>( * rr );
 
-    return is_shopping_list_id_valid( session_user_id, r.shopping_list_id, true );
+    return is_shopping_list_id_valid( session_user_id, r.shopping_list_id, true, ctx );
 }
 
-bool PermChecker::is_allowed_web_GetShoppingRequestInfoRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_web_GetShoppingRequestInfoRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
     auto & r = dynamic_cast< const shopndrop_web_protocol::GetShoppingRequestInfoRequest &>( * rr );
 
-    return is_ride_id_valid( session_user_id, r.ride_id, true );
+    return is_ride_id_valid( session_user_id, r.ride_id, true, ctx );
 }
 
-bool PermChecker::is_allowed_web_GetDashScreenUserRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_web_GetDashScreenUserRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
 //    auto & r = dynamic_cast< const shopndrop_web_protocol::GetDashScreenUserRequest &>( * rr );
 
     return true;
 }
 
-bool PermChecker::is_allowed_web_GetDashScreenShopperRequest( user_id_t session_user_id, const basic_parser::Object * rr )
+bool PermChecker::is_allowed_web_GetDashScreenShopperRequest( user_id_t session_user_id, const basic_parser::Object * rr, RequestContext * ctx )
 {
 //    auto & r = dynamic_cast< const shopndrop_web_protocol::GetDashScreenShopperRequest &>( * rr );
 
     return true;
 }
 
-bool PermChecker::is_allowed_lead_reg_RegisterUserRequest( user_id_t session_user_id, const basic_parser::Object * r )
+bool PermChecker::is_allowed_lead_reg_RegisterUserRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx )
 {
     return true;
 }
@@ -231,45 +263,41 @@ bool PermChecker::does_belong_to_user( user_id_t user_id, user_id_t session_user
     return should_belong_to_user ? false : true;
 }
 
-bool PermChecker::is_ride_id_valid( user_id_t session_user_id, uint32_t ride_id, bool should_belong_to_user )
+bool PermChecker::is_ride_id_valid( user_id_t session_user_id, uint32_t ride_id, bool should_belong_to_user, RequestContext * ctx )
 {
-    auto & mutex = order_db_->get_mutex();
-
-    MUTEX_SCOPE_LOCK( mutex );
-
-    auto ride = order_db_->find_ride__unlocked( ride_id );
+    auto ride = order_db_->get_ride( ride_id );
 
     if( ride == nullptr )
         return false;
 
+    if( ctx )
+        ctx->ride   = ride;
+
     return does_belong_to_user( ride->get_attrib().user_id, session_user_id, should_belong_to_user );
 }
 
-bool PermChecker::is_order_id_valid( user_id_t session_user_id, uint32_t order_id, bool should_belong_to_user )
+bool PermChecker::is_order_id_valid( user_id_t session_user_id, uint32_t order_id, bool should_belong_to_user, RequestContext * ctx )
 {
-    auto & mutex = order_db_->get_mutex();
-
-    MUTEX_SCOPE_LOCK( mutex );
-
-    auto order = order_db_->find_order__unlocked( order_id );
+    auto order = order_db_->get_order( order_id );
 
     if( order == nullptr )
         return false;
 
+    if( ctx )
+        ctx->order  = order;
+
     return does_belong_to_user( order->get_attrib().user_id, session_user_id, should_belong_to_user );
 }
 
-bool PermChecker::is_shopping_list_id_valid( user_id_t session_user_id, uint32_t shopping_list_id, bool should_belong_to_user )
+bool PermChecker::is_shopping_list_id_valid( user_id_t session_user_id, uint32_t shopping_list_id, bool should_belong_to_user, RequestContext * ctx )
 {
-    auto & mutex = order_db_->get_mutex();
-
-    MUTEX_SCOPE_LOCK( mutex );
-
-    auto shopping_list = order_db_->find_shopping_list__unlocked( shopping_list_id );
+    auto shopping_list = order_db_->get_shopping_list( shopping_list_id );
 
     if( shopping_list == nullptr )
         return false;
 
+    ctx->shopping_list  = shopping_list;
+
     //return does_belong_to_user( shopping_list->get_attrib().user_id, session_user_id, should_belong_to_user );
     return true;
 }
@@ -27,6 +27,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "session_manager/session_manager.h"        // session_manager::SessionManager
 #include "generic_handler/perm_checker.h"        // generic_handler::PermChecker
 #include "db_order_db.h"                         // db::OrderDB
+#include "request_context.h"                     // RequestContext
+#include "session_cache.h"                       // SessionCache
 
 namespace shopndrop {
 
@@ -43,41 +45,50 @@ public:
 
     // quasi-interface IHandler
     bool is_authenticated( user_id_t * session_user_id, const basic_parser::Object * r );
-    bool is_allowed( user_id_t session_user_id, const basic_parser::Object * r );
+    void purge_session_cache();
+
+    // must be called after a session was closed, the session is rejected from then on
+    void invalidate_session( const std::string & session_id );
+
+    // fills ctx with the objects resolved during the check
+    bool is_allowed( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
 
 private:
-    bool is_allowed_AddRideRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_GetRideRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_CancelRideRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_user_management_GetUserInfoRequest( user_id_t session_user_id, const basic_parser::Object * r );
-
-    bool is_allowed_AddOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_CancelOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_AcceptOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_DeclineOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_MarkDeliveredOrderRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_RateShopperRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_GetRideOrderInfoRequest( user_id_t session_user_id, const basic_parser::Object * r );
-
-    bool is_allowed_web_GetProductItemListRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_web_GetShoppingListWithTotalsRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_web_GetShoppingRequestInfoRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_web_GetDashScreenUserRequest( user_id_t session_user_id, const basic_parser::Object * r );
-    bool is_allowed_web_GetDashScreenShopperRequest( user_id_t session_user_id, const basic_parser::Object * r );
-
-    bool is_allowed_lead_reg_RegisterUserRequest( user_id_t session_user_id, const basic_parser::Object * r );
+    bool is_allowed_AddRideRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_GetRideRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_CancelRideRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_user_management_GetUserInfoRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+
+    bool is_allowed_AddOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_CancelOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_AcceptOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_DeclineOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_MarkDeliveredOrderRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_RateShopperRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_GetRideOrderInfoRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+
+    bool is_allowed_web_GetProductItemListRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_web_GetShoppingListWithTotalsRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_web_GetShoppingRequestInfoRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_web_GetDashScreenUserRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+    bool is_allowed_web_GetDashScreenShopperRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
+
+    bool is_allowed_lead_reg_RegisterUserRequest( user_id_t session_user_id, const basic_parser::Object * r, RequestContext * ctx );
 
     static bool does_belong_to_user( user_id_t user_id, user_id_t session_user_id, bool should_belong_to_user );
 
-    bool is_ride_id_valid( user_id_t session_user_id, uint32_t ride_id, bool should_belong_to_user );
-    bool is_order_id_valid( user_id_t session_user_id, uint32_t order_id, bool should_belong_to_user );
-    bool is_shopping_list_id_valid( user_id_t session_user_id, uint32_t shopping_list_id, bool should_belong_to_user );
+    // ctx may be nullptr, the checks of mutations don't keep the object, see RequestContext
+    bool is_ride_id_valid( user_id_t session_user_id, uint32_t ride_id, bool should_belong_to_user, RequestContext * ctx );
+    bool is_order_id_valid( user_id_t session_user_id, uint32_t order_id, bool should_belong_to_user, RequestContext * ctx );
+    bool is_shopping_list_id_valid( user_id_t session_user_id, uint32_t shopping_list_id, bool should_belong_to_user, RequestContext * ctx );
     bool validate_user_id( user_id_t session_user_id, uint32_t user_id );
 
 private:
     generic_handler::PermChecker        * generic_perm_checker_;
     session_manager::SessionManager            * sess_man_;
     db::OrderDB                         * order_db_;
+
+    SessionCache                        session_cache_;
 };
 
 } // namespace shopndrop
@@ -0,0 +1,86 @@
+/*
+
+Query Parameters.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "query_params.h"               // self
+
+#include <cstdlib>                      // strtoul
+#include <cerrno>                       // errno
+#include <cctype>                       // isdigit
+
+#include "generic_request/parser.h"     // generic_request::Parser
+#include "generic_request/request_decoder.h"    // generic_request::decode_request
+
+namespace shopndrop {
+
+bool QueryParams::parse( const std::string & s, std::string * error_msg )
+{
+    try
+    {
+        request_    = generic_request::decode_request( generic_request::Parser::to_request( s ) );
+    }
+    catch( std::exception & e )
+    {
+        * error_msg = std::string( "cannot parse parameters: " ) + e.what();
+        return false;
+    }
+
+    return true;
+}
+
+const std::string & QueryParams::get( const std::string & key ) const
+{
+    static const std::string empty;
+
+    if( request_.has_param( key ) == false )
+        return empty;
+
+    return request_.get_param( key );
+}
+
+bool QueryParams::get_uint( uint32_t * res, const std::string & key, uint32_t default_value, std::string * error_msg ) const
+{
+    auto & s = get( key );
+
+    if( s.empty() )
+    {
+        * res = default_value;
+        return true;
+    }
+
+    char * end = nullptr;
+
+    errno   = 0;
+
+    auto v = strtoul( s.c_str(), & end, 10 );
+
+    // strtoul accepts leading spaces and signs and wraps negative values around
+    if( isdigit( static_cast<unsigned char>( s[0] ) ) == 0 || * end != '\0' || errno == ERANGE || v > 0xFFFFFFFF )
+    {
+        * error_msg = "invalid value of " + key + " '" + s + "'";
+        return false;
+    }
+
+    * res = static_cast<uint32_t>( v );
+
+    return true;
+}
+
+} // namespace shopndrop
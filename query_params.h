@@ -0,0 +1,55 @@
+/*
+
+Query Parameters.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHOPNDROP__QUERY_PARAMS_H
+#define SHOPNDROP__QUERY_PARAMS_H
+
+#include <string>                   // std::string
+#include <cstdint>                  // uint32_t
+
+#include "generic_request/request.h"    // generic_request::Request
+
+namespace shopndrop {
+
+/**
+ * @brief Parameters of requests which are not covered by the protocol libraries.
+ *
+ * Format: KEY1=value1&KEY2=value2, values are URL encoded. Parsed and decoded by generic_request.
+ */
+class QueryParams
+{
+public:
+
+    bool parse( const std::string & s, std::string * error_msg );
+
+    // returns an empty string if the parameter is missing
+    const std::string & get( const std::string & key ) const;
+
+    bool get_uint( uint32_t * res, const std::string & key, uint32_t default_value, std::string * error_msg ) const;
+
+private:
+
+    generic_request::Request    request_;
+};
+
+} // namespace shopndrop
+
+#endif // SHOPNDROP__QUERY_PARAMS_H
@@ -0,0 +1,46 @@
+/*
+
+Request Context.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHOPNDROP__REQUEST_CONTEXT_H
+#define SHOPNDROP__REQUEST_CONTEXT_H
+
+#include "db_order_db.h"            // db::OrderDB
+
+namespace shopndrop {
+
+/**
+ * @brief Objects resolved by PermChecker while checking a request, handed over to Handler,
+ * so that the handler doesn't look them up again.
+ *
+ * The objects are immutable snapshots, they stay valid even if OrderDB changes meanwhile.
+ * Only read requests get them: OrderDB copies an object on modification while a snapshot of it
+ * is still held, so mutations are dispatched with an empty context.
+ */
+struct RequestContext
+{
+    db::OrderDB::RidePtr            ride;
+    db::OrderDB::OrderPtr           order;
+    db::OrderDB::ShoppingListPtr    shopping_list;
+};
+
+} // namespace shopndrop
+
+#endif // SHOPNDROP__REQUEST_CONTEXT_H
@@ -0,0 +1,101 @@
+/*
+
+Session Cache.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "session_cache.h"              // self
+
+#include "utils/mutex_helper.h"      // MUTEX_SCOPE_LOCK
+
+namespace shopndrop {
+
+SessionCache::SessionCache():
+    ttl_( 0 )
+{
+}
+
+void SessionCache::init( uint32_t ttl_sec )
+{
+    ttl_    = std::chrono::seconds( ttl_sec );
+}
+
+bool SessionCache::find( user_id_t * user_id, const std::string & session_id )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    auto it = sessions_.find( session_id );
+
+    if( it == sessions_.end() )
+        return false;
+
+    if( it->second.expiration <= Clock::now() )
+    {
+        sessions_.erase( it );
+        return false;
+    }
+
+    * user_id = it->second.user_id;
+
+    return true;
+}
+
+void SessionCache::add( const std::string & session_id, user_id_t user_id )
+{
+    if( ttl_.count() == 0 )
+        return;
+
+    auto expiration = Clock::now() + ttl_;
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    sessions_[ session_id ] = { user_id, expiration };
+}
+
+void SessionCache::remove( const std::string & session_id )
+{
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    sessions_.erase( session_id );
+}
+
+uint32_t SessionCache::purge()
+{
+    uint32_t res = 0;
+
+    auto now = Clock::now();
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    for( auto it = sessions_.begin(); it != sessions_.end(); )
+    {
+        if( it->second.expiration <= now )
+        {
+            it = sessions_.erase( it );
+            ++res;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    return res;
+}
+
+} // namespace shopndrop
@@ -0,0 +1,78 @@
+/*
+
+Session Cache.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHOPNDROP__SESSION_CACHE_H
+#define SHOPNDROP__SESSION_CACHE_H
+
+#include <string>                   // std::string
+#include <mutex>                    // std::mutex
+#include <unordered_map>            // std::unordered_map
+#include <chrono>                   // std::chrono
+
+#include "types.h"                  // user_id_t
+
+namespace shopndrop {
+
+/**
+ * @brief Short-lived TTL cache of validated sessions.
+ *
+ * Saves the session_manager lookup for repeated requests of the same session. It doesn't add
+ * any concurrency, the calls from Thunk are serialized by its mutex anyway.
+ * Entries expire after a short time to live, expired entries are removed lazily on lookup and by purge().
+ * A closed session must be removed explicitly, otherwise it stays valid until it expires.
+ */
+class SessionCache
+{
+public:
+
+    SessionCache();
+
+    void init( uint32_t ttl_sec );
+
+    bool find( user_id_t * user_id, const std::string & session_id );
+    void add( const std::string & session_id, user_id_t user_id );
+    void remove( const std::string & session_id );
+
+    // removes expired entries, returns the number of removed entries
+    uint32_t purge();
+
+private:
+
+    typedef std::chrono::steady_clock   Clock;
+
+    struct Entry
+    {
+        user_id_t           user_id;
+        Clock::time_point   expiration;
+    };
+
+private:
+
+    std::mutex              mutex_;     // find/add/remove come from Thunk, purge() from the scheduler
+
+    std::chrono::seconds    ttl_;
+
+    std::unordered_map<std::string, Entry>  sessions_;
+};
+
+} // namespace shopndrop
+
+#endif // SHOPNDROP__SESSION_CACHE_H
@@ -0,0 +1,113 @@
+/*
+
+Session Cache Test.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "../session_cache.h"           // SessionCache
+
+#include <iostream>                     // std::cout
+#include <thread>                       // std::this_thread
+#include <cstdlib>                      // EXIT_SUCCESS
+
+#define CHECK( _cond )  if( !( _cond ) ) { std::cout << "FAILED: " #_cond " at line " << __LINE__ << std::endl; return false; }
+
+bool test_find_after_add()
+{
+    shopndrop::SessionCache c;
+
+    c.init( 5 );
+
+    shopndrop::user_id_t user_id = 0;
+
+    CHECK( c.find( & user_id, "s1" ) == false );
+
+    c.add( "s1", 13 );
+
+    CHECK( c.find( & user_id, "s1" ) );
+    CHECK( user_id == 13 );
+
+    return true;
+}
+
+// a closed session must be rejected right away, not only after the time to live
+bool test_rejected_right_after_close()
+{
+    shopndrop::SessionCache c;
+
+    c.init( 5 );
+
+    c.add( "s1", 13 );
+    c.add( "s2", 14 );
+
+    // what Thunk does via PermChecker::invalidate_session() after CloseSessionRequest
+    c.remove( "s1" );
+
+    shopndrop::user_id_t user_id = 0;
+
+    CHECK( c.find( & user_id, "s1" ) == false );
+    CHECK( c.find( & user_id, "s2" ) );
+    CHECK( user_id == 14 );
+
+    return true;
+}
+
+bool test_expiration()
+{
+    shopndrop::SessionCache c;
+
+    c.init( 1 );
+
+    c.add( "s1", 13 );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1100 ) );
+
+    shopndrop::user_id_t user_id = 0;
+
+    CHECK( c.purge() == 1 );
+    CHECK( c.find( & user_id, "s1" ) == false );
+
+    return true;
+}
+
+bool test_disabled()
+{
+    shopndrop::SessionCache c;
+
+    c.init( 0 );
+
+    c.add( "s1", 13 );
+
+    shopndrop::user_id_t user_id = 0;
+
+    CHECK( c.find( & user_id, "s1" ) == false );
+
+    return true;
+}
+
+int main()
+{
+    bool b = test_find_after_add()
+        && test_rejected_right_after_close()
+        && test_expiration()
+        && test_disabled();
+
+    std::cout << ( b ? "OK" : "FAILED" ) << std::endl;
+
+    return b ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -25,6 +25,9 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include <boost/algorithm/string/predicate.hpp>     // boost::algorithm::starts_with
 #include <cassert>
+#include <cstring>                                  // strlen
+#include <typeinfo>                                 // typeid
+#include <vector>                                   // std::vector
 
 #include "utils/mutex_helper.h"          // MUTEX_SCOPE_LOCK
 #include "utils/dummy_logger.h"          // dummy_log
@@ -44,18 +47,37 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "shopndrop_protocol/csv_helper.h"    // shopndrop_protocol::csv_helper
 #include "shopndrop_web_protocol/parser.h"          // shopndrop_web_protocol::parser
 #include "shopndrop_web_protocol/csv_helper.h"    // shopndrop_web_protocol::CsvResponseEncoder
+#include "shopndrop_protocol/object_initializer.h"        // shopndrop_protocol::create_AddRideResponse
+#include "shopndrop_web_protocol/object_initializer.h"    // shopndrop_web_protocol::create_GetProductItemListResponse
 
 #include "handler_thunk.h"              // HandlerThunk
+#include "handler.h"                    // Handler::VectorBatchResult
 #include "perm_checker.h"               // PermChecker
+#include "goodies_db.h"                 // GoodiesDB
+#include "request_context.h"            // RequestContext
 
 #define MODULENAME      "shopndrop::Thunk"
 
 namespace shopndrop {
 
+const char * const PIPELINE_PATH            = "/api/Pipeline";
+const uint32_t     PIPELINE_MAX_COMMANDS    = 16;
+
+const char * const BATCH_PATH               = "/api/Batch";
+const uint32_t     BATCH_MAX_COMMANDS       = 64;
+
+const char * const SEARCH_PATH              = "/api/SearchProductItems";
+const char * const PRODUCT_ITEM_PAGE_PATH   = "/api/GetProductItemPage";
+
+const uint32_t     PRODUCT_ITEM_PAGE_DEFAULT_SIZE   = 20;
+const uint32_t     PRODUCT_ITEM_PAGE_MAX_SIZE       = 100;
+
 Thunk::Thunk():
     perm_checker_( nullptr ),
     handler_thunk_( nullptr ),
-    user_reg_handler_thunk_( nullptr )
+    user_reg_handler_thunk_( nullptr ),
+    goodies_db_( nullptr ),
+    product_item_list_version_( 0 )
 {
 }
 
@@ -63,26 +85,46 @@ bool Thunk::init(
         PermChecker         * perm_checker,
         HandlerThunk        * hander,
         user_reg_handler::HandlerThunk      * user_reg_handler_thunk,
+        GoodiesDB           * goodies_db,
         const std::string   & request_log,
-        uint32_t            request_log_rotation_interval_min )
+        uint32_t            request_log_rotation_interval_min,
+        const AdmissionControl::Config      & admission_config )
 {
     assert( perm_checker );
     assert( hander );
     assert( user_reg_handler_thunk );
+    assert( goodies_db );
 
     MUTEX_SCOPE_LOCK( mutex_ );
 
     perm_checker_   = perm_checker;
     handler_thunk_  = hander;
     user_reg_handler_thunk_ = user_reg_handler_thunk;
+    goodies_db_     = goodies_db;
 
     logfile_.reset( new utils::LogfileTime( request_log, request_log_rotation_interval_min ) );
 
+    admission_control_.init( admission_config );
+
     return true;
 }
 
 const std::string Thunk::handle( restful_interface::method_type_e type, const std::string & path, const std::string & body, const std::string & origin )
 {
+    auto priority = get_priority( path, body );
+
+    AdmissionControl::Guard guard( & admission_control_, priority );
+
+    if( guard.is_admitted() == false )
+    {
+        dummy_log_warn( MODULENAME, "busy, shed request %s from %s", path.c_str(), origin.c_str() );
+
+        // shedding must stay cheap under overload, so the response is encoded only once
+        static const std::string busy_response = to_csv_error_response( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, "server is busy, try again later" );
+
+        return busy_response;
+    }
+
     MUTEX_SCOPE_LOCK( mutex_ );
 
     try
@@ -115,10 +157,59 @@ const std::string Thunk::handle( restful_interface::method_type_e type, const st
     }
 }
 
+std::string Thunk::to_csv_error_response( generic_protocol::ErrorResponse_type_e type, const std::string & error_msg )
+{
+    std::unique_ptr<generic_protocol::BackwardMessage> resp( generic_protocol::create_ErrorResponse( type, error_msg ) );
+
+    return generic_protocol::csv_helper::to_csv( *resp );
+}
+
+std::string Thunk::create_error_response( generic_protocol::ErrorResponse_type_e type, const std::string & error_msg, const std::string & origin )
+{
+    auto res = to_csv_error_response( type, error_msg );
+
+    log_response( origin, res );
+
+    return res;
+}
+
+const std::string & Thunk::get_cannot_parse_response()
+{
+    static const std::string res = to_csv_error_response( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT, "cannot parse" );
+
+    return res;
+}
+
+std::string Thunk::create_cannot_parse_response( const std::string & origin )
+{
+    auto & res = get_cannot_parse_response();
+
+    log_response( origin, res );
+
+    return res;
+}
+
 std::string Thunk::handle__( restful_interface::method_type_e type, const std::string & path, const std::string & body, const std::string & origin )
 {
     // private: no mutex lock
 
+    if( is_post_only_path( path ) && type != restful_interface::method_type_e::POST )
+    {
+        return create_error_response( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT, "method not allowed, " + path + " accepts POST only", origin );
+    }
+
+    if( path == PIPELINE_PATH )
+        return handle_pipeline( body, origin );
+
+    if( path == BATCH_PATH )
+        return handle_batch( body, origin );
+
+    if( path == SEARCH_PATH )
+        return handle_search( body, origin );
+
+    if( path == PRODUCT_ITEM_PAGE_PATH )
+        return handle_product_item_page( body, origin );
+
     std::string s = to_string( type, path, body );
 
     dummy_log_info( MODULENAME, "got request '%s'", s.c_str() );
@@ -139,6 +230,8 @@ std::string Thunk::handle__( restful_interface::method_type_e type, const std::s
     {
         std::unique_ptr<const generic_protocol::BackwardMessage> resp( user_reg_handler_thunk_->handle( 0, req.get() ) );
 
+        invalidate_closed_session( req.get() );
+
         auto res = user_reg_protocol::csv_helper::to_csv( *resp );
 
         log_response( origin, res );
@@ -152,6 +245,8 @@ std::string Thunk::handle__( restful_interface::method_type_e type, const std::s
     {
         std::unique_ptr<const generic_protocol::BackwardMessage> resp( handle( req.get() ) );
 
+        invalidate_closed_session( req.get() );
+
         auto res = user_management_protocol::csv_helper::to_csv( *resp );
 
         log_response( origin, res );
@@ -161,10 +256,21 @@ std::string Thunk::handle__( restful_interface::method_type_e type, const std::s
 
     req.reset( shopndrop_web_protocol::parser::to_forward_message( rd ) );
 
+    if( req != nullptr && typeid( * req ) == typeid( shopndrop_web_protocol::GetProductItemListRequest ) )
+    {
+        auto res = handle_GetProductItemListRequest( req.get() );
+
+        log_response( origin, res );
+
+        return res;
+    }
+
     if( req != nullptr )
     {
         std::unique_ptr<const generic_protocol::BackwardMessage> resp( handle( req.get() ) );
 
+        invalidate_closed_session( req.get() );
+
         std::string res = shopndrop_web_protocol::csv_helper::to_csv( *resp );
 
         log_response( origin, res );
@@ -172,54 +278,623 @@ std::string Thunk::handle__( restful_interface::method_type_e type, const std::s
         return res;
     }
 
-    std::unique_ptr<const generic_protocol::BackwardMessage> resp( generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT, "cannot parse" ) );
+    return create_cannot_parse_response( origin );
+}
 
-    auto res = generic_protocol::csv_helper::to_csv( *resp );
+generic_protocol::BackwardMessage* Thunk::handle( const basic_parser::Object * req )
+{
+    user_id_t session_user_id = 0;
+
+    if( perm_checker_->is_authenticated( & session_user_id, req ) == false )
+        return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::INVALID_OR_EXPIRED_SESSION, "invalid or expired session id" );
+
+    RequestContext ctx;
+
+    if( perm_checker_->is_allowed( session_user_id, req, & ctx ) )
+        return handler_thunk_->handle( session_user_id, req, ctx );
+
+    return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::NOT_PERMITTED, "no rights to execute request" );
+}
+
+bool Thunk::is_post_only_path( const std::string & path )
+{
+    // these requests carry their parameters in the body
+    return path == PIPELINE_PATH || path == BATCH_PATH || path == SEARCH_PATH || path == PRODUCT_ITEM_PAGE_PATH;
+}
+
+bool Thunk::invalidate_closed_session( const basic_parser::Object * req )
+{
+    // sessions are closed by the generic handler, which bypasses PermChecker, so its cache has to be told
+    auto r = dynamic_cast<const generic_protocol::CloseSessionRequest *>( req );
+
+    if( r == nullptr )
+        return false;
+
+    perm_checker_->invalidate_session( r->session_id );
+
+    return true;
+}
+
+std::string Thunk::handle_GetProductItemListRequest( const basic_parser::Object * req )
+{
+    user_id_t       session_user_id = 0;
+    RequestContext  ctx;
+
+    if( perm_checker_->is_authenticated( & session_user_id, req ) == false ||
+        perm_checker_->is_allowed( session_user_id, req, & ctx ) == false )
+    {
+        // let the regular path generate the error response
+        std::unique_ptr<const generic_protocol::BackwardMessage> resp( handle( req ) );
+
+        return shopndrop_web_protocol::csv_helper::to_csv( *resp );
+    }
+
+    return get_product_item_list( session_user_id, req );
+}
+
+std::string Thunk::get_product_item_list( user_id_t session_user_id, const basic_parser::Object * req )
+{
+    // private: session must be authenticated and request allowed
+
+    auto version = goodies_db_->get_version();
+
+    if( product_item_list_.empty() == false && product_item_list_version_ == version )
+    {
+        dummy_log_debug( MODULENAME, "product item list: cache hit, version %u", version );
+
+        return product_item_list_;
+    }
+
+    std::unique_ptr<const generic_protocol::BackwardMessage> resp( handler_thunk_->handle( session_user_id, req, RequestContext() ) );
+
+    std::string res = shopndrop_web_protocol::csv_helper::to_csv( *resp );
+
+    if( typeid( * resp ) != typeid( generic_protocol::ErrorResponse ) )
+    {
+        dummy_log_info( MODULENAME, "product item list: cached version %u", version );
+
+        product_item_list_          = res;
+        product_item_list_version_  = version;
+    }
+
+    return res;
+}
+
+/**
+ * Search POST body: SESSION_ID=...&QUERY=...[&OFFSET=...][&LIMIT=...]
+ * The response is a GetProductItemListResponse with the requested page of matches, best matches first.
+ */
+std::string Thunk::handle_search( const std::string & body, const std::string & origin )
+{
+    // private: no mutex lock
+
+    log_request( origin, SEARCH_PATH + std::string( " " ) + body );
+
+    QueryParams params;
+    uint32_t    offset;
+    uint32_t    limit;
+    std::string error_msg;
+
+    if( params.parse( body, & error_msg ) == false || get_page( & offset, & limit, params, & error_msg ) == false )
+    {
+        return create_error_response( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT, error_msg, origin );
+    }
+
+    std::string res;
+
+    if( is_product_item_list_allowed( & res, params.get( "SESSION_ID" ) ) )
+    {
+        std::vector<shopndrop_web_protocol::ProductItemWithId> product_items;
+
+        auto total = goodies_db_->search( & product_items, params.get( "QUERY" ), offset, limit );
+
+        dummy_log_debug( MODULENAME, "search: found %u item(s), returning %u", total, static_cast<uint32_t>( product_items.size() ) );
+
+        res = to_csv_product_item_list( product_items );
+    }
 
     log_response( origin, res );
 
     return res;
 }
 
-generic_protocol::BackwardMessage* Thunk::handle( const basic_parser::Object * req )
+/**
+ * Page POST body: SESSION_ID=...[&CATEGORY=...][&OFFSET=...][&LIMIT=...]
+ * The response is a GetProductItemListResponse with the requested page of the category, all items if CATEGORY is empty.
+ */
+std::string Thunk::handle_product_item_page( const std::string & body, const std::string & origin )
+{
+    // private: no mutex lock
+
+    log_request( origin, PRODUCT_ITEM_PAGE_PATH + std::string( " " ) + body );
+
+    QueryParams params;
+    uint32_t    offset;
+    uint32_t    limit;
+    std::string error_msg;
+
+    if( params.parse( body, & error_msg ) == false || get_page( & offset, & limit, params, & error_msg ) == false )
+    {
+        return create_error_response( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT, error_msg, origin );
+    }
+
+    std::string res;
+
+    if( is_product_item_list_allowed( & res, params.get( "SESSION_ID" ) ) )
+    {
+        std::vector<shopndrop_web_protocol::ProductItemWithId> product_items;
+
+        auto & category = params.get( "CATEGORY" );
+
+        auto total = goodies_db_->get_product_items( & product_items, category, offset, limit );
+
+        dummy_log_debug( MODULENAME, "product item page: category '%s' has %u item(s), returning %u", category.c_str(), total, static_cast<uint32_t>( product_items.size() ) );
+
+        res = to_csv_product_item_list( product_items );
+    }
+
+    log_response( origin, res );
+
+    return res;
+}
+
+bool Thunk::is_product_item_list_allowed( std::string * error_response, const std::string & session_id )
+{
+    // requests outside of the protocol libraries need the same rights as GetProductItemListRequest
+    shopndrop_web_protocol::GetProductItemListRequest req;
+
+    req.session_id  = session_id;
+
+    user_id_t       session_user_id = 0;
+    RequestContext  ctx;
+
+    if( perm_checker_->is_authenticated( & session_user_id, & req ) == false )
+    {
+        * error_response = to_csv_error_response( generic_protocol::ErrorResponse_type_e::INVALID_OR_EXPIRED_SESSION, "invalid or expired session id" );
+        return false;
+    }
+
+    if( perm_checker_->is_allowed( session_user_id, & req, & ctx ) == false )
+    {
+        * error_response = to_csv_error_response( generic_protocol::ErrorResponse_type_e::NOT_PERMITTED, "no rights to execute request" );
+        return false;
+    }
+
+    return true;
+}
+
+bool Thunk::get_page( uint32_t * offset, uint32_t * limit, const QueryParams & params, std::string * error_msg )
+{
+    if( params.get_uint( offset, "OFFSET", 0, error_msg ) == false ||
+        params.get_uint( limit, "LIMIT", PRODUCT_ITEM_PAGE_DEFAULT_SIZE, error_msg ) == false )
+        return false;
+
+    if( * limit == 0 || * limit > PRODUCT_ITEM_PAGE_MAX_SIZE )
+    {
+        * error_msg = "LIMIT must be 1.." + std::to_string( PRODUCT_ITEM_PAGE_MAX_SIZE );
+        return false;
+    }
+
+    return true;
+}
+
+std::string Thunk::to_csv_product_item_list( const std::vector<shopndrop_web_protocol::ProductItemWithId> & product_items )
+{
+    std::unique_ptr<const generic_protocol::BackwardMessage> resp( shopndrop_web_protocol::create_GetProductItemListResponse( product_items ) );
+
+    return shopndrop_web_protocol::csv_helper::to_csv( *resp );
+}
+
+/**
+ * Pipeline POST body: the first line holds the parameters common to all commands (e.g. the session id),
+ * every following line holds one command, e.g. "CMD=GetDashScreenUserRequest&...".
+ * The session is authenticated once, commands are executed in order, their responses are returned
+ * one per line in the same order.
+ */
+std::string Thunk::handle_pipeline( const std::string & body, const std::string & origin )
+{
+    // private: no mutex lock
+
+    std::vector<std::string>    commands;
+    std::string                 error_msg;
+
+    if( split_commands( & commands, & error_msg, body, PIPELINE_MAX_COMMANDS ) == false )
+    {
+        return create_error_response( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT, "pipeline " + error_msg, origin );
+    }
+
+    bool        is_authenticated    = false;
+    user_id_t   session_user_id     = 0;
+
+    std::string res;
+
+    for( uint32_t i = 0; i < commands.size(); ++i )
+    {
+        if( i > 0 )
+            res.append( 1, '\n' );
+
+        res += handle_pipeline_command( & is_authenticated, & session_user_id, commands[i], origin );
+    }
+
+    log_response( origin, res );
+
+    return res;
+}
+
+/**
+ * Batch POST body: same layout as the pipeline body, but all commands must be either AddRideRequest or AddOrderRequest.
+ * All items are added in one OrderDB critical section, each item succeeds or fails on its own,
+ * the results are returned one per line in the same order.
+ */
+std::string Thunk::handle_batch( const std::string & body, const std::string & origin )
 {
+    // private: no mutex lock
+
+    std::vector<std::string>    commands;
+    std::string                 error_msg;
+
+    if( split_commands( & commands, & error_msg, body, BATCH_MAX_COMMANDS ) == false )
+    {
+        return create_error_response( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT, "batch " + error_msg, origin );
+    }
+
+    std::vector<shopndrop_protocol::AddRideRequest>     rides;
+    std::vector<shopndrop_protocol::AddOrderRequest>    orders;
+
+    for( uint32_t i = 0; i < commands.size(); ++i )
+    {
+        generic_request::Request r = generic_request::Parser::to_request( commands[i] );
+
+        log_request( origin, generic_request::StrHelper::to_string( r ) );
+
+        std::unique_ptr<basic_parser::Object> req( shopndrop_web_protocol::parser::to_forward_message( generic_request::decode_request( r ) ) );
+
+        auto ride   = dynamic_cast<const shopndrop_protocol::AddRideRequest *>( req.get() );
+        auto order  = dynamic_cast<const shopndrop_protocol::AddOrderRequest *>( req.get() );
+
+        if( ride != nullptr && orders.empty() )
+        {
+            rides.push_back( * ride );
+        }
+        else if( order != nullptr && rides.empty() )
+        {
+            orders.push_back( * order );
+        }
+        else
+        {
+            return create_error_response( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT,
+                    "batch command " + std::to_string( i + 1 ) + ": expected only AddRideRequest or only AddOrderRequest commands", origin );
+        }
+    }
+
+    bool is_ride = ( rides.empty() == false );
+
+    // the session is shared by all commands, so it is checked for the first one only
+    const basic_parser::Object * first = is_ride ? static_cast<const basic_parser::Object *>( & rides[0] ) : & orders[0];
+
     user_id_t session_user_id = 0;
 
-    if( perm_checker_->is_authenticated( & session_user_id, req ) == false )
-        return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::INVALID_OR_EXPIRED_SESSION, "invalid or expired session id" );
+    if( perm_checker_->is_authenticated( & session_user_id, first ) == false )
+    {
+        return create_error_response( generic_protocol::ErrorResponse_type_e::INVALID_OR_EXPIRED_SESSION, "invalid or expired session id", origin );
+    }
 
-    if( perm_checker_->is_allowed( session_user_id, req ) )
-        return handler_thunk_->handle( session_user_id, req );
+    for( uint32_t i = 0; i < commands.size(); ++i )
+    {
+        RequestContext ctx;
 
-    return generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::NOT_PERMITTED, "no rights to execute request" );
+        const basic_parser::Object * req = is_ride ? static_cast<const basic_parser::Object *>( & rides[i] ) : & orders[i];
+
+        if( perm_checker_->is_allowed( session_user_id, req, & ctx ) == false )
+        {
+            return create_error_response( generic_protocol::ErrorResponse_type_e::NOT_PERMITTED, "no rights to execute request", origin );
+        }
+    }
+
+    Handler::VectorBatchResult results;
+
+    if( is_ride )
+        handler_thunk_->handle_batch( & results, session_user_id, rides );
+    else
+        handler_thunk_->handle_batch( & results, session_user_id, orders );
+
+    std::string res;
+
+    for( uint32_t i = 0; i < results.size(); ++i )
+    {
+        auto & e = results[i];
+
+        std::unique_ptr<const generic_protocol::BackwardMessage> resp(
+                ( e.id == 0 ) ? generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, e.error_msg ) :
+                is_ride ?       shopndrop_protocol::create_AddRideResponse( e.id ) :
+                                shopndrop_protocol::create_AddOrderResponse( e.id ) );
+
+        if( i > 0 )
+            res.append( 1, '\n' );
+
+        res += shopndrop_web_protocol::csv_helper::to_csv( *resp );
+    }
+
+    log_response( origin, res );
+
+    return res;
+}
+
+bool Thunk::split_commands( std::vector<std::string> * res, std::string * error_msg, const std::string & body, uint32_t max_commands )
+{
+    std::vector<std::string> lines;
+
+    size_t start = 0;
+
+    while( start <= body.size() )
+    {
+        auto pos = body.find( '\n', start );
+
+        auto line = body.substr( start, pos == std::string::npos ? std::string::npos : pos - start );
+
+        if( line.empty() == false && line.back() == '\r' )
+            line.pop_back();
+
+        if( line.empty() == false || lines.empty() )
+            lines.push_back( std::move( line ) );
+
+        if( pos == std::string::npos )
+            break;
+
+        start = pos + 1;
+    }
+
+    if( lines.size() < 2 || lines.size() > max_commands + 1 )
+    {
+        * error_msg = "must contain 1.." + std::to_string( max_commands ) + " commands";
+        return false;
+    }
+
+    auto & common = lines[0];
+
+    res->reserve( lines.size() - 1 );
+
+    for( uint32_t i = 1; i < lines.size(); ++i )
+    {
+        res->push_back( std::move( lines[i] ) );
+
+        if( common.empty() == false )
+            res->back().append( 1, '&' ).append( common );
+    }
+
+    return true;
+}
+
+std::string Thunk::handle_pipeline_command( bool * is_authenticated, user_id_t * session_user_id, const std::string & s, const std::string & origin )
+{
+    // private: no mutex lock
+
+    try
+    {
+        generic_request::Request r = generic_request::Parser::to_request( s );
+
+        log_request( origin, generic_request::StrHelper::to_string( r ) );
+
+        protocol_e protocol;
+
+        std::unique_ptr<basic_parser::Object> req( to_forward_message( & protocol, generic_request::decode_request( r ) ) );
+
+        if( req == nullptr )
+        {
+            return get_cannot_parse_response();
+        }
+
+        // the session is shared by all commands, so it is checked for the first one only
+        if( * is_authenticated == false )
+        {
+            if( perm_checker_->is_authenticated( session_user_id, req.get() ) == false )
+            {
+                std::unique_ptr<const generic_protocol::BackwardMessage> resp( generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::INVALID_OR_EXPIRED_SESSION, "invalid or expired session id" ) );
+
+                return to_csv( protocol, *resp );
+            }
+
+            * is_authenticated = true;
+        }
+
+        RequestContext ctx;
+
+        if( perm_checker_->is_allowed( * session_user_id, req.get(), & ctx ) == false )
+        {
+            std::unique_ptr<const generic_protocol::BackwardMessage> resp( generic_protocol::create_ErrorResponse( generic_protocol::ErrorResponse_type_e::NOT_PERMITTED, "no rights to execute request" ) );
+
+            return to_csv( protocol, *resp );
+        }
+
+        if( typeid( * req ) == typeid( shopndrop_web_protocol::GetProductItemListRequest ) )
+        {
+            return get_product_item_list( * session_user_id, req.get() );
+        }
+
+        std::unique_ptr<const generic_protocol::BackwardMessage> resp( handler_thunk_->handle( * session_user_id, req.get(), ctx ) );
+
+        // the following commands must not run on the closed session
+        if( invalidate_closed_session( req.get() ) )
+            * is_authenticated = false;
+
+        return to_csv( protocol, *resp );
+    }
+    catch( basic_parser::MalformedRequest & e )
+    {
+        dummy_log_info( MODULENAME, "malformed pipeline command '%s'", e.what() );
+
+        return to_csv_error_response( generic_protocol::ErrorResponse_type_e::INVALID_ARGUMENT, std::string( "malformed request: " ) + e.what() );
+    }
+    catch( std::exception & e )
+    {
+        // the responses of the preceding commands are kept, only this command fails
+        dummy_log_error( MODULENAME, "exception in pipeline command '%s'", e.what() );
+
+        return to_csv_error_response( generic_protocol::ErrorResponse_type_e::RUNTIME_ERROR, std::string( "cannot process request: " ) + e.what() );
+    }
+}
+
+basic_parser::Object * Thunk::to_forward_message( protocol_e * protocol, const generic_request::Request & rd )
+{
+    // user registration doesn't need a session, so it isn't accepted in a pipeline
+
+    auto res = user_management_protocol::parser::to_forward_message( rd );
+
+    if( res != nullptr )
+    {
+        * protocol  = protocol_e::USER_MANAGEMENT;
+        return res;
+    }
+
+    res = shopndrop_web_protocol::parser::to_forward_message( rd );
+
+    * protocol  = ( res != nullptr ) ? protocol_e::SHOPNDROP_WEB : protocol_e::UNDEF;
+
+    return res;
+}
+
+std::string Thunk::to_csv( protocol_e protocol, const generic_protocol::BackwardMessage & resp )
+{
+    switch( protocol )
+    {
+    case protocol_e::USER_MANAGEMENT:
+        return user_management_protocol::csv_helper::to_csv( resp );
+
+    case protocol_e::SHOPNDROP_WEB:
+        return shopndrop_web_protocol::csv_helper::to_csv( resp );
+
+    default:
+        return generic_protocol::csv_helper::to_csv( resp );
+    }
+}
+
+AdmissionControl::Stats Thunk::get_and_reset_admission_stats()
+{
+    return admission_control_.get_and_reset_stats();
+}
+
+AdmissionControl::priority_e Thunk::get_priority( const std::string & path, const std::string & body )
+{
+    static const char   API_PREFIX[]    = "/api/";
+    static const size_t API_PREFIX_LEN  = sizeof( API_PREFIX ) - 1;
+
+    if( path == PIPELINE_PATH )
+        return get_pipeline_priority( body );
+
+    if( boost::algorithm::starts_with( path, API_PREFIX ) && is_low_priority_command( path.substr( API_PREFIX_LEN ) ) )
+        return AdmissionControl::priority_e::LOW;
+
+    return AdmissionControl::priority_e::HIGH;
+}
+
+AdmissionControl::priority_e Thunk::get_pipeline_priority( const std::string & body )
+{
+    std::vector<std::string>    commands;
+    std::string                 error_msg;
+
+    // a malformed pipeline is rejected right after admission, so it is cheap either way
+    if( split_commands( & commands, & error_msg, body, PIPELINE_MAX_COMMANDS ) == false )
+        return AdmissionControl::priority_e::LOW;
+
+    // a single mutation makes the whole pipeline a mutation
+    for( auto & c : commands )
+    {
+        if( is_low_priority_command( get_command_name( c ) ) == false )
+            return AdmissionControl::priority_e::HIGH;
+    }
+
+    return AdmissionControl::priority_e::LOW;
+}
+
+bool Thunk::is_low_priority_command( const std::string & cmd )
+{
+    // dashboard polls and catalog reads are repeated by clients anyway, so they give way to other requests and are shed first
+    static const char * const low_priority_commands[] =
+    {
+        "GetDashScreenUserRequest",
+        "GetDashScreenShopperRequest",
+        "GetProductItemListRequest",
+        "GetShoppingRequestInfoRequest",
+        "SearchProductItems",
+        "GetProductItemPage",
+    };
+
+    for( auto c : low_priority_commands )
+    {
+        if( cmd == c )
+            return true;
+    }
+
+    return false;
+}
+
+std::string Thunk::get_command_name( const std::string & s )
+{
+    static const char   CMD_KEY[]       = "CMD=";
+    static const size_t CMD_KEY_LEN     = sizeof( CMD_KEY ) - 1;
+
+    size_t pos = 0;
+
+    while( ( pos = s.find( CMD_KEY, pos ) ) != std::string::npos )
+    {
+        if( pos == 0 || s[pos - 1] == '&' )
+        {
+            auto start  = pos + CMD_KEY_LEN;
+            auto end    = s.find( '&', start );
+
+            return s.substr( start, end == std::string::npos ? std::string::npos : end - start );
+        }
+
+        pos += CMD_KEY_LEN;
+    }
+
+    return std::string();
 }
 
 std::string Thunk::to_string( restful_interface::method_type_e type, const std::string & path, const std::string & body )
 {
+    static const char   API_PREFIX[]    = "/api/";
+    static const size_t API_PREFIX_LEN  = sizeof( API_PREFIX ) - 1;
+
+    // assemble in one buffer, this runs for every request
     std::string res;
 
-    if( boost::algorithm::starts_with( path, "/api/" ) )
+    res.reserve( 4 + path.size() + 1 + body.size() );
+
+    if( boost::algorithm::starts_with( path, API_PREFIX ) )
     {
-        res = "CMD=" + path.substr( 5 );
+        res.append( "CMD=" ).append( path, API_PREFIX_LEN, std::string::npos );
     }
     else
     {
-        res = path;
+        res.append( path );
     }
 
-    res += "&" + body;
+    res.append( 1, '&' ).append( body );
 
     return res;
 }
 
 void Thunk::log_request( const std::string & origin, const std::string & s ) const
 {
-    logfile_->write( "REQ " + origin + " " + s );
+    log( "REQ ", origin, s );
 }
 
 void Thunk::log_response( const std::string & origin, const std::string & s ) const
 {
-    logfile_->write( "RESP " + origin + " " + s );
+    log( "RESP ", origin, s );
+}
+
+void Thunk::log( const char * prefix, const std::string & origin, const std::string & s ) const
+{
+    // responses can be large, so assemble the line in one buffer
+    std::string line;
+
+    line.reserve( strlen( prefix ) + origin.size() + 1 + s.size() );
+
+    line.append( prefix ).append( origin ).append( 1, ' ' ).append( s );
+
+    logfile_->write( line );
 }
 
 } // namespace shopndrop
@@ -26,17 +26,24 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #define THUNK_H
 
 #include <mutex>                // std::mutex
+#include <vector>               // std::vector
 
 
 #include "utils/logfile_time.h"                  // utils::LogfileTime
 #include "restful_interface/i_handler.h"         // restful_interface::IHandler
 #include "generic_protocol/protocol.h"   // generic_protocol::ForwardMessage
 #include "user_reg_handler/handler_thunk.h"     // user_reg_handler::HandlerThunk
+#include "generic_request/request.h"             // generic_request::Request
+#include "shopndrop_web_protocol/protocol.h"     // shopndrop_web_protocol::ProductItemWithId
+#include "types.h"                              // user_id_t
+#include "admission_control.h"                  // AdmissionControl
+#include "query_params.h"                       // QueryParams
 
 namespace shopndrop {
 
 class PermChecker;
 class HandlerThunk;
+class GoodiesDB;
 
 class Thunk: public virtual restful_interface::IHandler
 {
@@ -47,19 +54,64 @@ public:
             PermChecker         * perm_checker,
             HandlerThunk             * hander,
             user_reg_handler::HandlerThunk      * user_reg_handler_thunk,
+            GoodiesDB           * goodies_db,
             const std::string   & request_log,
-            uint32_t            request_log_rotation_interval_min );
+            uint32_t            request_log_rotation_interval_min,
+            const AdmissionControl::Config      & admission_config );
 
     virtual const std::string handle( restful_interface::method_type_e type, const std::string & path, const std::string & body, const std::string & origin ) override;
 
+    AdmissionControl::Stats get_and_reset_admission_stats();
+
+private:
+
+    enum class protocol_e
+    {
+        UNDEF,
+        USER_MANAGEMENT,
+        SHOPNDROP_WEB,
+    };
+
 private:
     std::string handle__( restful_interface::method_type_e type, const std::string & path, const std::string & body, const std::string & origin );
 
+    static std::string to_csv_error_response( generic_protocol::ErrorResponse_type_e type, const std::string & error_msg );
+    std::string create_error_response( generic_protocol::ErrorResponse_type_e type, const std::string & error_msg, const std::string & origin );
+    static const std::string & get_cannot_parse_response();
+    std::string create_cannot_parse_response( const std::string & origin );
+
     generic_protocol::BackwardMessage* handle( const basic_parser::Object * req );
 
+    static bool is_post_only_path( const std::string & path );
+    bool invalidate_closed_session( const basic_parser::Object * req );
+
+    std::string handle_GetProductItemListRequest( const basic_parser::Object * req );
+    std::string get_product_item_list( user_id_t session_user_id, const basic_parser::Object * req );
+
+    std::string handle_search( const std::string & body, const std::string & origin );
+    std::string handle_product_item_page( const std::string & body, const std::string & origin );
+
+    bool is_product_item_list_allowed( std::string * error_response, const std::string & session_id );
+    static bool get_page( uint32_t * offset, uint32_t * limit, const QueryParams & params, std::string * error_msg );
+    static std::string to_csv_product_item_list( const std::vector<shopndrop_web_protocol::ProductItemWithId> & product_items );
+
+    std::string handle_pipeline( const std::string & body, const std::string & origin );
+    std::string handle_batch( const std::string & body, const std::string & origin );
+    static bool split_commands( std::vector<std::string> * res, std::string * error_msg, const std::string & body, uint32_t max_commands );
+    std::string handle_pipeline_command( bool * is_authenticated, user_id_t * session_user_id, const std::string & s, const std::string & origin );
+
+    static basic_parser::Object * to_forward_message( protocol_e * protocol, const generic_request::Request & rd );
+    static std::string to_csv( protocol_e protocol, const generic_protocol::BackwardMessage & resp );
+
+    static AdmissionControl::priority_e get_priority( const std::string & path, const std::string & body );
+    static AdmissionControl::priority_e get_pipeline_priority( const std::string & body );
+    static bool is_low_priority_command( const std::string & cmd );
+    static std::string get_command_name( const std::string & s );
+
     static std::string to_string( restful_interface::method_type_e type, const std::string & path, const std::string & body );
     void log_request( const std::string & origin, const std::string & s ) const;
     void log_response( const std::string & origin, const std::string & s ) const;
+    void log( const char * prefix, const std::string & origin, const std::string & s ) const;
 
 private:
     mutable std::mutex          mutex_;
@@ -67,8 +119,15 @@ private:
     PermChecker                 * perm_checker_;
     HandlerThunk                * handler_thunk_;
     user_reg_handler::HandlerThunk      * user_reg_handler_thunk_;
+    GoodiesDB                   * goodies_db_;
 
     std::unique_ptr<utils::LogfileTime>    logfile_;
+
+    AdmissionControl            admission_control_;     // serializes requests instead of waiting on mutex_
+
+    // encoded GetProductItemListResponse, valid while the catalog version doesn't change
+    std::string                 product_item_list_;
+    uint32_t                    product_item_list_version_;
 };
 
 } // namespace shopndrop
@@ -19,6 +19,7 @@ done
 
 [[ ! -f ../$RUNTIME_DIR/resources/date_time_zonespec.csv ]] && ln -sf ../../../persek_res/date_time_zonespec.csv ../$RUNTIME_DIR/resources
 [[ ! -f ../$RUNTIME_DIR/resources/registration_template.txt ]] && ln -sf ../../registration_template.txt ../$RUNTIME_DIR/resources
+[[ ! -f ../$RUNTIME_DIR/resources/goodies.csv ]] && ln -sf ../../goodies.csv ../$RUNTIME_DIR/resources
 
 FILES="shopndrop.ini example"
 
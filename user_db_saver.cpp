@@ -0,0 +1,120 @@
+/*
+
+User DB Saver.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "user_db_saver.h"              // self
+
+#include <chrono>                       // std::chrono
+
+#include "utils/mutex_helper.h"      // MUTEX_SCOPE_LOCK
+#include "utils/dummy_logger.h"      // dummy_log
+#include "utils/utils_assert.h"      // ASSERT
+
+#define MODULENAME      "UserDbSaver"
+
+namespace shopndrop {
+
+UserDbSaver::UserDbSaver():
+    user_man_( nullptr ),
+    interval_min_( 60 ),
+    should_stop_( false )
+{
+}
+
+UserDbSaver::~UserDbSaver()
+{
+    shutdown();
+}
+
+void UserDbSaver::init( user_manager::UserManager * user_man, const std::string & filename, uint32_t interval_min )
+{
+    ASSERT( user_man );
+
+    MUTEX_SCOPE_LOCK( mutex_ );
+
+    user_man_       = user_man;
+    filename_       = filename;
+    interval_min_   = ( interval_min > 0 ) ? interval_min : 1;
+}
+
+void UserDbSaver::start()
+{
+    dummy_log_info( MODULENAME, "start: interval %u min", interval_min_ );
+
+    thread_ = std::thread( & UserDbSaver::thread_func, this );
+}
+
+void UserDbSaver::shutdown()
+{
+    {
+        MUTEX_SCOPE_LOCK( mutex_ );
+
+        should_stop_    = true;
+
+        cond_.notify_one();
+    }
+
+    if( thread_.joinable() )
+        thread_.join();
+}
+
+bool UserDbSaver::save()
+{
+    MUTEX_SCOPE_LOCK( mutex_save_ );
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::string error_msg;
+
+    auto b = user_man_->save( & error_msg, filename_ );
+
+    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ).count();
+
+    if( b == false )
+    {
+        dummy_log_error( MODULENAME, "cannot save %s: %s", filename_.c_str(), error_msg.c_str() );
+        return false;
+    }
+
+    dummy_log_info( MODULENAME, "saved %s in %u ms", filename_.c_str(), static_cast<uint32_t>( duration_ms ) );
+
+    return true;
+}
+
+void UserDbSaver::thread_func()
+{
+    while( true )
+    {
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+
+            cond_.wait_for( lock, std::chrono::minutes( interval_min_ ), [this]{ return should_stop_; } );
+
+            if( should_stop_ )
+                break;
+        }
+
+        save();
+    }
+
+    dummy_log_info( MODULENAME, "thread stopped" );
+}
+
+} // namespace shopndrop
@@ -0,0 +1,75 @@
+/*
+
+User DB Saver.
+
+Copyright (C) 2019 Sergey Kolevatov
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SHOPNDROP__USER_DB_SAVER_H
+#define SHOPNDROP__USER_DB_SAVER_H
+
+#include <string>                   // std::string
+#include <mutex>                    // std::mutex
+#include <condition_variable>       // std::condition_variable
+#include <thread>                   // std::thread
+
+#include "user_manager/user_manager.h"      // user_manager::UserManager
+
+namespace shopndrop {
+
+/**
+ * @brief Saves the user DB periodically in its own thread, so that the scheduler thread isn't stalled.
+ */
+class UserDbSaver
+{
+public:
+
+    UserDbSaver();
+    ~UserDbSaver();
+
+    void init( user_manager::UserManager * user_man, const std::string & filename, uint32_t interval_min );
+
+    void start();
+
+    // stops the thread, doesn't save
+    void shutdown();
+
+    // saves in the calling thread
+    bool save();
+
+private:
+
+    void thread_func();
+
+private:
+    std::mutex                  mutex_;
+    std::condition_variable     cond_;
+
+    std::mutex                  mutex_save_;    // serializes saving
+
+    user_manager::UserManager   * user_man_;
+    std::string                 filename_;
+    uint32_t                    interval_min_;
+
+    bool                        should_stop_;
+
+    std::thread                 thread_;
+};
+
+} // namespace shopndrop
+
+#endif // SHOPNDROP__USER_DB_SAVER_H